@@ -0,0 +1,228 @@
+'''
+    BenchScaling
+    Strong/weak scaling of the interaction engines and output modes:
+    sweeps N over powers of two and the # of worker threads, writes one CSV
+    row per run and reports complexity exponents and parallel efficiencies.
+    Plot the CSV with PlotScaling.py.
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Usage:
+        python BenchScaling.py -o scaling.csv           # all engines, N=8...2^20
+        python BenchScaling.py --engines voronoi_tiled --Nmax 65536
+        python PlotScaling.py scaling.csv
+'''
+import os
+import re
+import sys
+import csv
+import time as pytime
+import shutil
+import argparse
+import tempfile
+import subprocess
+import numpy as np
+import SwarmDynByPy as swarmPy
+
+# interaction engines: parameters of swarmdyn (threads: if parallel)
+engines = {'voronoi': {'kNN': 0, 'engine': 0},          # 1 triangulation per step
+           'voronoi_tiled': {'kNN': 0, 'engine': 0},    # tiled, vor_threads = threads
+           'knn': {'kNN': 7, 'engine': 0},              # topological, kd-tree
+           'global': {'kNN': 0, 'engine': 1}}           # all pairs O(N^2)
+parallel_engines = ['voronoi_tiled']
+output_modes = {'off': 2, 'mean': 0, 'full': 1}   # -> params['output_mode']
+columns = ['engine', 'threads', 'N', 'output', 'steps', 'exit_code', 'wall_s',
+           'step_s', 'interaction_s', 'update_s', 'output_s', 'agent_steps_per_s',
+           'peak_rss_mb']
+
+
+def read_timing(fname):
+    '''
+    total seconds per phase from timing_xx.dat (see phase_timers.h)
+    '''
+    total = dict()
+    if not os.path.exists(fname):
+        return total
+    with open(fname) as f:
+        for line in f:
+            if line.startswith('#'):
+                continue
+            words = line.split()
+            if len(words) > 2:
+                total[words[0]] = float(words[2])
+    return total
+
+
+def run_once(exe, engine, threads, N, output, steps, mode, seed):
+    '''
+    runs swarmdyn for steps steps with timers (-M 1) and txt output
+    the arena grows with N (constant density of the initial school)
+    '''
+    dic = swarmPy.get_base_params(0, 0, mode=mode)
+    dt = dic['dt']
+    dic['time'] = steps * dt
+    dic['trans_time'] = 0
+    dic['pred_time'] = dic['time'] + 1  # no predator: scaling of the prey
+    dic['Npred'] = 0
+    dic['N'] = N
+    dic['size'] = max(dic['size'], 1.7 * np.sqrt(N))
+    dic['output_mode'] = output_modes[output]
+    dic['out_h5'] = 0
+    dic['timing'] = 1
+    dic['seed'] = seed
+    dic.update(engines[engine])
+    dic['vor_threads'] = threads if engine in parallel_engines else 0
+    path = tempfile.mkdtemp(prefix='swarmscale_')
+    dic['path'] = path + '/'
+    command = swarmPy.dic2swarmdyn_command(dic, exe=os.path.abspath(exe))
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    t0 = pytime.perf_counter()
+    proc = subprocess.Popen(command.split(), cwd=path, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL, universal_newlines=True)
+    stdout, _ = proc.communicate()
+    wall = pytime.perf_counter() - t0
+    rss = re.search(r'peak RSS: (\S+) MB', stdout)
+    T = read_timing(path + '/timing_xx.dat')
+    shutil.rmtree(path)
+    interaction = sum([T.get(k, 0) for k in ['neighbors', 'forces', 'pred_detect']])
+    out = sum([T.get(k, 0) for k in ['out_swarm', 'out_fishnet', 'out_part', 'out_pred']])
+    step = sum(T.values()) - out
+    return {'engine': engine, 'threads': threads, 'N': N, 'output': output,
+            'steps': steps, 'exit_code': proc.returncode, 'wall_s': wall,
+            'step_s': step / steps, 'interaction_s': interaction / steps,
+            'update_s': T.get('update', 0) / steps, 'output_s': out / steps,
+            'agent_steps_per_s': N * steps / max(step + out, 1e-12),
+            'peak_rss_mb': float(rss.group(1)) if rss else float('nan')}
+
+
+def fit_exponent(N, t, Nmin):
+    '''
+    exponent b of t ~ N^b (least squares in log-log for N >= Nmin)
+    '''
+    N = np.asarray(N, dtype=float)
+    t = np.asarray(t, dtype=float)
+    there = (N >= Nmin) & (t > 0)
+    if there.sum() < 2:
+        return float('nan')
+    return np.polyfit(np.log(N[there]), np.log(t[there]), 1)[0]
+
+
+def report(rows, Nmin):
+    '''
+    complexity exponents of the time per step (step_s + output_s) per series
+    and strong / weak parallel efficiency of the parallel engines
+    '''
+    def cost(r):
+        return r['step_s'] + r['output_s']
+    print('\ncomplexity exponents (time per step ~ N^b, fit for N >= {}):'.format(Nmin))
+    series = sorted(set([(r['engine'], r['threads'], r['output']) for r in rows]))
+    for s in series:
+        sel = [r for r in rows if (r['engine'], r['threads'], r['output']) == s
+               and r['exit_code'] == 0]
+        b = fit_exponent([r['N'] for r in sel], [cost(r) for r in sel], Nmin)
+        bi = fit_exponent([r['N'] for r in sel], [r['interaction_s'] for r in sel], Nmin)
+        print('{:14s} threads {:3d} output {:5s}: b = {:5.2f} (interaction {:5.2f}), N <= {}'.format(
+              s[0], s[1], s[2], b, bi, max([r['N'] for r in sel] + [0])))
+    for engine in sorted(set([r['engine'] for r in rows]) & set(parallel_engines)):
+        t = {(r['N'], r['threads']): cost(r) for r in rows
+             if r['engine'] == engine and r['output'] == 'off' and r['exit_code'] == 0}
+        threads = sorted(set([k[1] for k in t.keys()]))
+        Ns = sorted(set([k[0] for k in t.keys()]))
+        if len(threads) < 2:
+            continue
+        print('\n{}: strong scaling efficiency T(N,1) / (p T(N,p)):'.format(engine))
+        print('{:>9s} '.format('N') + ' '.join(['{:>6d}'.format(p) for p in threads]))
+        for N in Ns:
+            if (N, 1) not in t:
+                continue
+            eff = [t[(N, 1)] / (p * t[(N, p)]) if (N, p) in t else float('nan')
+                   for p in threads]
+            print('{:9d} '.format(N) + ' '.join(['{:6.2f}'.format(e) for e in eff]))
+        print('\n{}: weak scaling efficiency T(N,1) / T(p N,p):'.format(engine))
+        print('{:>9s} '.format('N') + ' '.join(['{:>6d}'.format(p) for p in threads]))
+        for N in Ns:
+            if (N, 1) not in t:
+                continue
+            eff = [t[(N, 1)] / t[(N * p, p)] if (N * p, p) in t else float('nan')
+                   for p in threads]
+            print('{:9d} '.format(N) + ' '.join(['{:6.2f}'.format(e) for e in eff]))
+
+
+def main():
+    ncores = os.cpu_count()
+    parser = argparse.ArgumentParser(description='scaling of the interaction engines')
+    parser.add_argument('--exe', default='./swarmdyn')
+    parser.add_argument('--engines', nargs='+', default=list(engines.keys()),
+                        choices=list(engines.keys()))
+    parser.add_argument('--outputs', nargs='+', default=['off', 'mean', 'full'],
+                        choices=list(output_modes.keys()),
+                        help='output modes (swept with the 1st engine, 1 thread)')
+    parser.add_argument('--Nmin', type=int, default=8)
+    parser.add_argument('--Nmax', type=int, default=2**20)
+    parser.add_argument('--threads', nargs='+', type=int, default=None,
+                        help='worker counts of the parallel engines (default 1, 2, 4, ... cores)')
+    parser.add_argument('--steps', type=int, default=200)
+    parser.add_argument('--mode', default='burst_coast', choices=swarmPy.possible_modes)
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--max-wall', type=float, default=60,
+                        help='larger N of a series are skipped after a run took longer [s]')
+    parser.add_argument('--fit-Nmin', type=int, default=256,
+                        help='smallest N of the exponent fit')
+    parser.add_argument('-o', '--out', default='scaling.csv')
+    args = parser.parse_args()
+
+    threads = args.threads
+    if threads is None:
+        threads = [2**k for k in range(int(np.log2(ncores)) + 1)]
+        if threads[-1] != ncores:
+            threads.append(ncores)
+    Ns = [2**k for k in range(int(np.log2(args.Nmin)), int(np.log2(args.Nmax)) + 1)]
+    # series: (engine, threads, output)
+    series = []
+    for engine in args.engines:
+        for p in (threads if engine in parallel_engines else [1]):
+            series.append((engine, p, 'off'))
+    for output in args.outputs:
+        if output != 'off':
+            series.append((args.engines[0], 1, output))
+
+    rows = []
+    with open(args.out, 'w') as f:
+        writer = csv.DictWriter(f, fieldnames=columns)
+        writer.writeheader()
+        for engine, p, output in series:
+            for N in Ns:
+                row = run_once(args.exe, engine, p, N, output, args.steps,
+                               args.mode, args.seed)
+                writer.writerow(row)
+                f.flush()
+                rows.append(row)
+                print('{:14s} threads {:3d} output {:5s} N {:8d}: {:10.4g} s/step '
+                      '(interaction {:10.4g}, output {:10.4g}) {:8.1f} MB{}'.format(
+                      engine, p, output, N, row['step_s'], row['interaction_s'],
+                      row['output_s'], row['peak_rss_mb'],
+                      '' if row['exit_code'] == 0 else '  FAILED'))
+                sys.stdout.flush()
+                if row['wall_s'] > args.max_wall or row['exit_code'] != 0:
+                    break
+    print('-> ' + args.out)
+    report(rows, args.fit_Nmin)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
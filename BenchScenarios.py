@@ -0,0 +1,195 @@
+'''
+    BenchScenarios
+    Benchmark of the production scenarios (SwarmDynByPy.get_base_params):
+    runs swarmdyn for every scenario, N and output mode with fixed seeds and
+    reports throughput, peak memory and output size. A stored result can be
+    used as baseline to flag regressions.
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Usage:
+        python BenchScenarios.py -o bench_scenarios.json
+        python BenchScenarios.py -o new.json --compare bench_scenarios.json  # run + compare
+        python BenchScenarios.py --input new.json --compare base.json  # compare only
+'''
+import os
+import re
+import sys
+import json
+import time as pytime
+import shutil
+import socket
+import argparse
+import tempfile
+import subprocess
+import numpy as np
+import SwarmDynByPy as swarmPy
+
+scenarios = ['burst_coast', 'natPred', 'natPredNoConfu', 'sinFisher', 'mulFisher']
+output_modes = {'off': 2, 'mean': 0, 'full': 1}   # -> params['output_mode']
+
+
+def run_once(exe, dic):
+    '''
+    runs swarmdyn with the parameters dic in a fresh directory
+    OUTPUT:
+        dict with wall time, peak RSS and output bytes
+    '''
+    path = tempfile.mkdtemp(prefix='swarmbench_')
+    dic['path'] = path + '/'
+    command = swarmPy.dic2swarmdyn_command(dic, exe=os.path.abspath(exe))
+    t0 = pytime.perf_counter()
+    proc = subprocess.Popen(command.split(), cwd=path, stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL, universal_newlines=True)
+    stdout, _ = proc.communicate()
+    wall = pytime.perf_counter() - t0
+    # swarmdyn prints its peak RSS: the rusage of a child includes the
+    # memory of the (forked) python process
+    rss = re.search(r'peak RSS: (\S+) MB', stdout)
+    rss = float(rss.group(1)) if rss else float('nan')
+    out_bytes = 0
+    for f in os.listdir(path):
+        if f != 'parameters.dat':
+            out_bytes += os.path.getsize(os.path.join(path, f))
+    shutil.rmtree(path)
+    return {'seed': dic['seed'], 'exit_code': proc.returncode, 'wall_s': wall,
+            'peak_rss_mb': rss, 'output_bytes': out_bytes}
+
+
+def run_case(exe, mode, N, output, sim_time, reps, seed):
+    '''
+    runs reps seeds (seed, seed+1, ...) of scenario mode with N agents
+    agent-steps are counted with the initial N (kills are not subtracted)
+    '''
+    dic = swarmPy.get_base_params(sim_time / 2, sim_time / 2, mode=mode)
+    dic['N'] = N
+    dic['output_mode'] = output_modes[output]
+    runs = []
+    for k in range(reps):
+        dic['seed'] = seed + k
+        runs.append(run_once(exe, dic))
+    steps = int(dic['time'] / dic['dt'])
+    wall = np.median([r['wall_s'] for r in runs])
+    return {'mode': mode, 'N': N, 'output': output, 'sim_time': dic['time'],
+            'steps': steps, 'wall_s': wall,
+            'agent_steps_per_s': N * steps / wall,
+            'sim_s_per_wall_s': dic['time'] / wall,
+            'peak_rss_mb': np.max([r['peak_rss_mb'] for r in runs]),
+            'output_bytes': int(np.median([r['output_bytes'] for r in runs])),
+            'failed': sum([r['exit_code'] != 0 for r in runs]),
+            'runs': runs}
+
+
+def print_result(res):
+    print('{:16s} {:6d} {:5s} {:10.3f} s {:12.4g} ag-st/s {:8.3g} sim-s/s {:8.1f} MB {:12d} B{}'.format(
+          res['mode'], res['N'], res['output'], res['wall_s'],
+          res['agent_steps_per_s'], res['sim_s_per_wall_s'],
+          res['peak_rss_mb'], res['output_bytes'],
+          '  FAILED' if res['failed'] else ''))
+    sys.stdout.flush()
+
+
+def compare(results, baseline, threshold):
+    '''
+    compares results with baseline (same mode, N, output)
+    regression: throughput below (1 - threshold) x baseline or
+                peak RSS / output bytes above (1 + threshold) x baseline
+    OUTPUT:
+        # of regressions
+    '''
+    base = {(b['mode'], b['N'], b['output']): b for b in baseline['results']}
+    regressions = 0
+    print('\ncompare to baseline (threshold {:.0f}%): ratio new / baseline'.format(100 * threshold))
+    for res in results['results']:
+        key = (res['mode'], res['N'], res['output'])
+        if key not in base:
+            print('{:16s} {:6d} {:5s} not in baseline'.format(*key))
+            continue
+        b = base[key]
+        speed = res['agent_steps_per_s'] / b['agent_steps_per_s']
+        rss = res['peak_rss_mb'] / b['peak_rss_mb']
+        size = (res['output_bytes'] + 1.) / (b['output_bytes'] + 1.)
+        flags = []
+        if speed < 1 - threshold:
+            flags.append('throughput')
+        if rss > 1 + threshold:
+            flags.append('memory')
+        if size > 1 + threshold:
+            flags.append('output')
+        if res['failed']:
+            flags.append('failed')
+        regressions += len(flags) > 0
+        print('{:16s} {:6d} {:5s} throughput {:6.3f} rss {:6.3f} output {:6.3f} {}'.format(
+              key[0], key[1], key[2], speed, rss, size,
+              '-> REGRESSION (' + ', '.join(flags) + ')' if flags else 'ok'))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='benchmark of the production scenarios')
+    parser.add_argument('--exe', default='./swarmdyn')
+    parser.add_argument('--modes', nargs='+', default=scenarios, choices=scenarios)
+    parser.add_argument('--N', nargs='+', type=int, default=[30, 100, 1000])
+    parser.add_argument('--outputs', nargs='+', default=['off', 'mean', 'full'],
+                        choices=list(output_modes.keys()))
+    parser.add_argument('--time', type=float, default=2,
+                        help='simulated seconds (predator after half of it)')
+    parser.add_argument('--reps', type=int, default=3, help='seeds per case (median)')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('-o', '--out', default='bench_scenarios.json')
+    parser.add_argument('--input', default=None,
+                        help='compare this result file instead of running')
+    parser.add_argument('--compare', default=None, help='baseline result file')
+    parser.add_argument('--threshold', type=float, default=0.1)
+    args = parser.parse_args()
+
+    # baseline first: the run must not overwrite it
+    baseline = None
+    if args.compare is not None:
+        if args.input is None and os.path.abspath(args.out) == os.path.abspath(args.compare):
+            print('--out {} would overwrite the baseline, choose another -o'.format(args.out))
+            return 2
+        with open(args.compare) as f:
+            baseline = json.load(f)
+
+    if args.input is not None:
+        with open(args.input) as f:
+            results = json.load(f)
+    else:
+        results = {'suite': 'scenarios', 'host': socket.gethostname(),
+                   'exe': os.path.abspath(args.exe), 'reps': args.reps,
+                   'seed': args.seed, 'date': pytime.strftime('%Y-%m-%d %H:%M:%S'),
+                   'results': []}
+        for mode in args.modes:
+            for N in args.N:
+                for output in args.outputs:
+                    res = run_case(args.exe, mode, N, output, args.time,
+                                   args.reps, args.seed)
+                    print_result(res)
+                    results['results'].append(res)
+        with open(args.out, 'w') as f:
+            json.dump(results, f, indent=1)
+        print('-> ' + args.out)
+
+    if baseline is not None:
+        if compare(results, baseline, args.threshold) > 0:
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,93 @@
+'''
+    PlotScaling
+    plots the CSV of BenchScaling.py: time per step vs N (log-log) per
+    engine / thread count / output mode and the strong scaling efficiency
+    of the parallel engines.
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Usage:
+        python PlotScaling.py scaling.csv [scaling.png]
+'''
+import sys
+import csv
+import numpy as np
+import matplotlib
+if __name__ == '__main__':
+    matplotlib.use('Agg')
+import matplotlib.pyplot as plt
+
+
+def load(fname):
+    with open(fname) as f:
+        rows = [r for r in csv.DictReader(f) if int(r['exit_code']) == 0]
+    for r in rows:
+        for k in ['threads', 'N']:
+            r[k] = int(r[k])
+        for k in ['step_s', 'interaction_s', 'output_s']:
+            r[k] = float(r[k])
+    return rows
+
+
+def main(fname, fout):
+    rows = load(fname)
+    fig, axs = plt.subplots(1, 2, figsize=(12, 5))
+    # time per step vs N
+    ax = axs[0]
+    series = sorted(set([(r['engine'], r['threads'], r['output']) for r in rows]))
+    for s in series:
+        sel = sorted([r for r in rows if (r['engine'], r['threads'], r['output']) == s],
+                     key=lambda r: r['N'])
+        N = np.array([r['N'] for r in sel])
+        t = np.array([r['step_s'] + r['output_s'] for r in sel])
+        ax.loglog(N, t, 'o-', label='{} p={} out={}'.format(*s))
+    N = np.array(sorted(set([r['N'] for r in rows])), dtype=float)
+    if len(N) > 1:  # guides
+        t0 = min([r['step_s'] for r in rows if r['step_s'] > 0] + [1e-6])
+        ax.loglog(N, t0 * N / N[0], 'k:', lw=1, label='~N')
+        ax.loglog(N, t0 * (N / N[0])**2, 'k--', lw=1, label='~N^2')
+    ax.set_xlabel('N')
+    ax.set_ylabel('time per step [s]')
+    ax.legend(fontsize=7)
+    # strong scaling efficiency
+    ax = axs[1]
+    for engine in sorted(set([r['engine'] for r in rows])):
+        t = {(r['N'], r['threads']): r['step_s'] for r in rows
+             if r['engine'] == engine and r['output'] == 'off'}
+        threads = sorted(set([k[1] for k in t.keys()]))
+        if len(threads) < 2:
+            continue
+        for N in sorted(set([k[0] for k in t.keys()])):
+            p = [q for q in threads if (N, q) in t]
+            if (N, 1) not in t or len(p) < 2:
+                continue
+            eff = [t[(N, 1)] / (q * t[(N, q)]) for q in p]
+            ax.plot(p, eff, 'o-', label='{} N={}'.format(engine, N))
+    ax.axhline(1, color='k', lw=1)
+    ax.set_xlabel('threads p')
+    ax.set_ylabel('efficiency T(1) / (p T(p))')
+    if ax.get_legend_handles_labels()[0]:
+        ax.legend(fontsize=7)
+    fig.tight_layout()
+    fig.savefig(fout, dpi=150)
+    print('-> ' + fout)
+
+
+if __name__ == '__main__':
+    fname = sys.argv[1] if len(sys.argv) > 1 else 'scaling.csv'
+    fout = sys.argv[2] if len(sys.argv) > 2 else fname.rsplit('.', 1)[0] + '.png'
+    main(fname, fout)
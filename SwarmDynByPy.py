@@ -59,6 +59,11 @@ def get_base_params(pred_time, record_time, mode=None, trans_time=None):
     params['path'] = "./"
     params["fileID"] = 'xx'  # not passed to the code, only there
     params["out_h5"] = 1 # output-format 0:txt 1:hdf5
+    params["timing"] = 0 # 1: time per phase of the step (group "timing" in output + summary), 2: + hardware counters (linux)
+    params["trace_every"] = 0 # >0: chrome trace (trace_fileID.json) of every trace_every-th step and output
+    params["alloc_check"] = 0 # >0: fails (exit code 1) if a step w/o predator allocates after alloc_check warm-up steps
+    params["progress"] = 0  # >0: progress report every progress seconds of wall time (stderr + progress_fileID.dat, see WatchRuns.py)
+    params["seed"] = 0  # >0: fixed seed of the random numbers (reproducible runs), 0: from the clock
     params["trans_time"] = pred_time + trans_time    # time till output starts (transient)
     params["time"] = pred_time + record_time + trans_time    # total time of simulation
     params['dt'] = 0.001
@@ -70,10 +75,14 @@ def get_base_params(pred_time, record_time, mode=None, trans_time=None):
     params["IC"] = 3     # recommended:2 global, 3 voronoi
     # BC    -1:no, 0: periodic, 1:inelastic, 2:elastic, 3:x peri, y ela
     #       4:x peri, y inela 5 elastic circle, 6 inelastic circle 
+    #       7 elastic arena from file (polygon or .pgm mask, relative to path)
     params["BC"] = -1
+    params["arena"] = 'none'   # arena geometry file (only BC=7)
+    params["arena_res"] = 0.1  # resolution of the signed distance field of the arena
 
     params["N"] = 8
     params["Npred"] = 0
+    params["Nrep"] = 1  # >1: Nrep independent replicates integrated in lockstep (only burst_coast)
 
     # #################### F behavior
     params["Dphi"] = 0.02 # 0.02, only relevant for single-fishing agents: influences persistence length!
@@ -81,8 +90,16 @@ def get_base_params(pred_time, record_time, mode=None, trans_time=None):
     params["rep_range"] = 0.5
     params["alg_range"] = 16.2
     params["att_range"] = 30  # 30.0
+    params["kNN"] = 0   # >0: topological interaction with kNN nearest neighbors, 0: voronoi
+    params["engine"] = 0    # if kNN=0: 0: voronoi, 1: global (all pairs within the zones, O(N^2)), -1: auto (fastest voronoi engine, calibrated per machine)
+    params["sfm"] = 0   # social force model 0: 4-zone, 1: smooth zones, 2: voronoi-edge weighted
+    params["sort_every"] = 0    # >0: re-sort agents in memory along a Hilbert curve every sort_every steps (N >= 10^4, e.g. 100)
+    params["vor_threads"] = 0   # >0: voronoi from tiled triangulations in parallel (large N), 0: single triangulation
     params['soc_strength'] = 110.82    # strength of social force (all social forces)
     params["burst_rate"] = 3.3
+    params["burst_dist"] = 0    # inter-burst intervals 0: geometric, 1: gamma, 2: lognormal, 3: empirical
+    params["burst_shape"] = 1   # shape of gamma / sigma of lognormal intervals (mean is 1/burst_rate)
+    params["burst_file"] = 'none'   # empirical intervals [s] (relative to path), "t [weight]" per line
 
     params["flee_range"] = 7  # Range at which prey detects pred/fishing-agent with prob=1
     # #################### P behavior
@@ -123,19 +140,21 @@ def get_base_params(pred_time, record_time, mode=None, trans_time=None):
     return params
 
 
-def dic2swarmdyn_command(dic):
+def dic2swarmdyn_command(dic, exe='./swarmdyn'):
     '''
     transforms dictionary of parameters to calls to swarmdyn.cpp
     INPUT:
         dic dictionary
             keys = parameter names
             values = parameter values
+        exe str
+            path of the executable
     '''
     #consistency check:
     for key in dic.keys():
         if 'time' in key:
             assert np.any(dic[key] >= 0), '{} has negative value {}'.format(key, dic[key])
-    command = './swarmdyn'
+    command = exe
     command += ' -L %g' % dic['size']
     command += ' -N %d' % dic['N']
     command += ' -n %d' % dic['Npred']
@@ -152,6 +171,11 @@ def dic2swarmdyn_command(dic):
     command += ' -R %g' % dic['env_strength']
     command += ' -o %g' % dic['output']
     command += ' -J %d' % dic['out_h5']
+    command += ' -M %d' % dic['timing']
+    command += ' -Z %d' % dic['trace_every']
+    command += ' -K %d' % dic['alloc_check']
+    command += ' -g %d' % dic['seed']
+    command += ' -p %g' % dic['progress']
     command += ' -d %g' % dic['dt']
     command += ' -t %g' % dic['time']
     command += ' -B %d' % dic['BC']
@@ -168,6 +192,17 @@ def dic2swarmdyn_command(dic):
     command += ' -Q %g' % dic['prob_social']
     command += ' -u %g' % dic['burst_duration']
     command += ' -Y %g' % dic['alphaTurn']
+    command += ' -y %d' % dic['Nrep']
+    command += ' -k %d' % dic['kNN']
+    command += ' -j %d' % dic['engine']
+    command += ' -F %d' % dic['sfm']
+    command += ' -C %d' % dic['sort_every']
+    command += ' -V %d' % dic['vor_threads']
+    command += ' -i %d' % dic['burst_dist']
+    command += ' -s %g' % dic['burst_shape']
+    command += ' -P %s' % dic['burst_file']
+    command += ' -W %s' % dic['arena']
+    command += ' -w %g' % dic['arena_res']
     return command
 
 possible_modes = ['burst_coast', 'sinFisher', 'mulFisher', 'natPred', 'natPredNoConfu', 'exploration']
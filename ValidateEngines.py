@@ -0,0 +1,232 @@
+'''
+    ValidateEngines
+    Statistical equivalence of a candidate engine (parameters and/or
+    executable) with the reference: both are run over many seeds per
+    scenario and the distributions of the per-run Out_swarm observables and
+    kill statistics are compared with two-sample Kolmogorov-Smirnov and
+    Anderson-Darling (permutation p-value) tests.
+    A faster engine is not bit-identical to the reference, but it must not
+    change the statistics.
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Usage:
+        python ValidateEngines.py --cand vor_threads=4
+        python ValidateEngines.py --cand-exe ./swarmdyn_new --modes natPred --seeds 100
+        python ValidateEngines.py --ref kNN=0 --cand engine=1 -o validate.json
+'''
+import os
+import sys
+import json
+import shutil
+import argparse
+import tempfile
+import warnings
+import subprocess
+import numpy as np
+from scipy import stats
+from concurrent.futures import ThreadPoolExecutor
+import SwarmDynByPy as swarmPy
+
+scenarios = ['burst_coast', 'natPred', 'natPredNoConfu', 'sinFisher', 'mulFisher']
+# columns of swarm_xx.dat (Out_swarm)
+observables = {'polarization': 1, 'L_norm': 2, 'hull_area': 12, 'NND': 13, 'IID': 14}
+col_Ndead = 3   # of swarm_fishNet_xx.dat (Out_swarm_fishNet)
+# one sample per run (independent), see samples()
+names = list(observables.keys()) + ['kills', 'first_kill', 'mean_kill_time']
+
+
+def parse_overrides(words):
+    '''
+    ['key=value', ...] -> dict (int, float or str values)
+    '''
+    dic = dict()
+    for w in words:
+        key, value = w.split('=', 1)
+        for typ in [int, float]:
+            try:
+                value = typ(value)
+                break
+            except ValueError:
+                pass
+        dic[key] = value
+    return dic
+
+
+def run_once(exe, dic):
+    '''
+    runs swarmdyn with txt-output in a fresh directory
+    OUTPUT:
+        time-averaged observables, kill times, # of kills
+        (None if the run failed)
+    '''
+    path = tempfile.mkdtemp(prefix='swarmval_')
+    dic = dict(dic, path=path + '/', out_h5=0, output_mode=0)
+    command = swarmPy.dic2swarmdyn_command(dic, exe=os.path.abspath(exe))
+    proc = subprocess.run(command.split(), cwd=path, stdout=subprocess.DEVNULL,
+                          stderr=subprocess.DEVNULL)
+    res = None
+    try:
+        if proc.returncode == 0:
+            swarm = np.loadtxt(path + '/swarm_xx.dat', ndmin=2)
+            f_net = path + '/swarm_fishNet_xx.dat'  # not written w/o predator
+            net = np.loadtxt(f_net, ndmin=2) if os.path.exists(f_net) else np.zeros((1, 4))
+            # rows after the extinction of all prey stay zero
+            alive = swarm[:, 0] > 0
+            res = {k: np.mean(swarm[alive, c]) for k, c in observables.items()}
+            # (the zero rows after an extinction keep the maximum)
+            Ndead = np.maximum.accumulate(net[:, col_Ndead])
+            t = dic['trans_time'] + dic['output'] * np.arange(len(Ndead))
+            # time of the k-th kill: first output with Ndead >= k
+            res['kill_times'] = [float(t[np.argmax(Ndead >= k)])
+                                 for k in range(1, int(Ndead[-1]) + 1)]
+            res['kills'] = int(Ndead[-1])
+    except (IOError, ValueError, IndexError):
+        res = None
+    shutil.rmtree(path)
+    return res
+
+
+def run_engine(exe, dic, seeds, jobs):
+    with ThreadPoolExecutor(max_workers=jobs) as pool:
+        runs = list(pool.map(lambda s: run_once(exe, dict(dic, seed=s)), seeds))
+    return [r for r in runs if r is not None], sum([r is None for r in runs])
+
+
+def samples(runs, name):
+    '''
+    one value per run (runs w/o kill are skipped for the kill times):
+        first_kill: time of the 1st kill
+        mean_kill_time: mean time of all kills
+    (the kill times of all runs pooled are not independent samples)
+    '''
+    if name == 'first_kill':
+        return np.array([r['kill_times'][0] for r in runs if len(r['kill_times']) > 0])
+    if name == 'mean_kill_time':
+        return np.array([np.mean(r['kill_times']) for r in runs if len(r['kill_times']) > 0])
+    return np.array([r[name] for r in runs], dtype=float)
+
+
+def two_sample_tests(x, y, resamples):
+    '''
+    p-values of the two-sample KS and Anderson-Darling (k-sample) test
+    (AD: permutation p-value >= 1 / (resamples + 1), the tabulated one of
+    scipy is capped to [0.001, 0.25] and could never fail)
+    '''
+    if len(x) < 2 or len(y) < 2:
+        return float('nan'), float('nan')
+    if np.ptp(np.concatenate((x, y))) == 0:  # all identical (e.g. no kills)
+        return 1., 1.
+    p_ks = stats.ks_2samp(x, y).pvalue
+    with warnings.catch_warnings():
+        warnings.simplefilter('ignore')
+        p_ad = stats.anderson_ksamp(
+            [x, y], method=stats.PermutationMethod(n_resamples=resamples)).pvalue
+    return float(p_ks), float(p_ad)
+
+
+def validate(args, ref, cand, resamples):
+    results = []
+    for mode in args.modes:
+        dic = swarmPy.get_base_params(args.pred_time, args.record_time, mode=mode)
+        if args.N is not None:
+            dic['N'] = args.N
+        seeds_ref = [args.seed + k for k in range(args.seeds)]
+        # independent seeds for the candidate (unless paired)
+        seeds_cand = seeds_ref if args.paired else [s + args.seeds for s in seeds_ref]
+        runs_ref, fail_ref = run_engine(args.ref_exe, dict(dic, **ref), seeds_ref, args.jobs)
+        runs_cand, fail_cand = run_engine(args.cand_exe, dict(dic, **cand), seeds_cand, args.jobs)
+        print('\n{}: N={} runs ref {} cand {} (failed {} / {})'.format(
+              mode, dic['N'], len(runs_ref), len(runs_cand), fail_ref, fail_cand))
+        print('{:14s} {:>11s} {:>11s} {:>8s} {:>8s}'.format(
+              'observable', 'mean ref', 'mean cand', 'p KS', 'p AD'))
+        for name in names:
+            x = samples(runs_ref, name)
+            y = samples(runs_cand, name)
+            p_ks, p_ad = two_sample_tests(x, y, resamples)
+            results.append({'mode': mode, 'observable': name, 'n_ref': len(x),
+                            'n_cand': len(y), 'mean_ref': float(np.mean(x)) if len(x) else None,
+                            'mean_cand': float(np.mean(y)) if len(y) else None,
+                            'p_ks': p_ks, 'p_ad': p_ad,
+                            'failed_runs': fail_ref + fail_cand})
+            print('{:14s} {:11.4g} {:11.4g} {:8.3g} {:8.3g}'.format(
+                  name, np.mean(x) if len(x) else np.nan,
+                  np.mean(y) if len(y) else np.nan, p_ks, p_ad))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description='statistical equivalence of engines')
+    parser.add_argument('--ref-exe', default='./swarmdyn')
+    parser.add_argument('--cand-exe', default=None, help='default: --ref-exe')
+    parser.add_argument('--ref', nargs='*', default=[], metavar='KEY=VALUE',
+                        help='parameters of the reference engine')
+    parser.add_argument('--cand', nargs='*', default=[], metavar='KEY=VALUE',
+                        help='parameters of the candidate engine')
+    parser.add_argument('--modes', nargs='+', default=scenarios, choices=scenarios)
+    parser.add_argument('--N', type=int, default=None, help='default: of the scenario')
+    parser.add_argument('--seeds', type=int, default=50, help='runs per engine and scenario')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--paired', action='store_true',
+                        help='same seeds for both engines (default: independent seeds)')
+    parser.add_argument('--pred-time', type=float, default=2)
+    parser.add_argument('--record-time', type=float, default=8)
+    parser.add_argument('--alpha', type=float, default=0.01,
+                        help='family-wise significance level (Bonferroni over all tests)')
+    parser.add_argument('--resamples', type=int, default=None,
+                        help='permutations of the AD test (default: 10 / alpha per test)')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count())
+    parser.add_argument('-o', '--out', default=None, help='json with all p-values')
+    args = parser.parse_args()
+    if args.cand_exe is None:
+        args.cand_exe = args.ref_exe
+    ref = parse_overrides(args.ref)
+    cand = parse_overrides(args.cand)
+
+    # Bonferroni: a test fails if min(p_KS, p_AD) < alpha / (2 * # of tests)
+    alpha = args.alpha / (2 * len(args.modes) * len(names))
+    resamples = args.resamples if args.resamples is not None else int(np.ceil(10 / alpha))
+    results = validate(args, ref, cand, resamples)
+    # samples on one side only (e.g. first_kill if one engine never kills)
+    # fail as well, no samples on both sides are not tested
+    for r in results:
+        r['one_sided'] = (r['n_ref'] > 0) != (r['n_cand'] > 0)
+    tested = [r for r in results if not np.isnan(r['p_ks']) or r['one_sided']]
+    failed = [r for r in tested if r['one_sided'] or min(r['p_ks'], r['p_ad']) < alpha]
+    print('\n{} of {} tests failed (alpha {:g}, per test {:.3g}, {} permutations)'.format(
+          len(failed), len(tested), args.alpha, alpha, resamples))
+    for r in failed:
+        if r['one_sided']:
+            print('FAIL {} {}: samples ref {} cand {}'.format(
+                  r['mode'], r['observable'], r['n_ref'], r['n_cand']))
+            continue
+        print('FAIL {} {}: p KS {:.3g} p AD {:.3g}'.format(
+              r['mode'], r['observable'], r['p_ks'], r['p_ad']))
+    passed = len(failed) == 0 and all([r['failed_runs'] == 0 for r in results])
+    print('-> ' + ('PASS' if passed else 'FAIL'))
+    if args.out is not None:
+        with open(args.out, 'w') as f:
+            json.dump({'ref_exe': os.path.abspath(args.ref_exe), 'ref': ref,
+                       'cand_exe': os.path.abspath(args.cand_exe), 'cand': cand,
+                       'seeds': args.seeds, 'alpha': args.alpha, 'resamples': resamples,
+                       'passed': passed, 'results': results}, f, indent=1)
+        print('-> ' + args.out)
+    return 0 if passed else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,139 @@
+'''
+    WatchRuns
+    polls the status files (progress_<fileID>.dat, swarmdyn -p) of several
+    runs, e.g. the workers of a parameter sweep, and prints one line per run
+    plus the aggregate. Flags stale runs (no update for 3 report intervals or
+    process gone), slowdowns (recent step rate below half of the mean rate
+    of the run) and stragglers (ETA far above the median of the running runs).
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Usage:
+        python WatchRuns.py path/of/runs                # once
+        python WatchRuns.py path1 path2 --interval 30   # every 30 s
+'''
+import os
+import sys
+import glob
+import time
+import socket
+import argparse
+import numpy as np
+
+
+def read_status(fname):
+    '''
+    "key: value" lines -> dict (numbers as float)
+    '''
+    status = dict()
+    with open(fname) as f:
+        for line in f:
+            if ':' not in line:
+                continue
+            key, value = line.split(':', 1)
+            value = value.strip()
+            try:
+                value = float(value)
+            except ValueError:
+                pass
+            status[key.strip()] = value
+    return status
+
+
+def process_alive(pid):
+    try:
+        os.kill(int(pid), 0)
+    except ProcessLookupError:
+        return False
+    except PermissionError:
+        pass
+    return True
+
+
+def flags(st, now, host, eta_median, straggler):
+    out = []
+    if st['state'] != 'running':
+        return out
+    if now - st['updated'] > 3 * st['every']:
+        out.append('stale')
+    if st['host'] == host and not process_alive(st['pid']):
+        out.append('gone')
+    if st['steps_per_s'] < 0.5 * st['mean_steps_per_s']:
+        out.append('slowdown')
+    if eta_median > 0 and st['eta'] > straggler * eta_median:
+        out.append('straggler')
+    return out
+
+
+def report(paths, straggler):
+    files = []
+    for p in paths:
+        files += glob.glob(os.path.join(p, 'progress_*.dat')) if os.path.isdir(p) else [p]
+    runs = []
+    for f in sorted(files):
+        try:
+            runs.append(read_status(f))
+        except (IOError, ValueError):
+            pass
+    now = time.time()
+    host = socket.gethostname()
+    running = [st for st in runs if st.get('state') == 'running']
+    eta_median = np.median([st['eta'] for st in running]) if running else 0
+    print('{:>16s} {:>9s} {:>7s} {:>11s} {:>8s} {:>8s} {:>6s} {:>9s} {:>9s}  {}'.format(
+          'fileID', 'state', 'done', 'steps/s', 'rtf', 'alive', 'dead', 'out MB',
+          'eta s', 'flags'))
+    for st in runs:
+        fl = flags(st, now, host, eta_median, straggler)
+        print('{:>16s} {:>9s} {:6.1f}% {:11.4g} {:8.3g} {:8d} {:6d} {:9.3g} {:9.1f}  {}'.format(
+              str(st['fileID']), st['state'], 100 * st['step'] / max(st['steps'], 1),
+              st['steps_per_s'], st['rtf'], int(st['alive']), int(st['dead']),
+              st['output_bytes'] / 2**20, st['eta'], ' '.join(fl)))
+    if len(runs) > 0:
+        done = sum([st['step'] for st in runs])
+        total = sum([st['steps'] for st in runs])
+        print('{} runs ({} running): {:.1f}% of all steps, {:.4g} steps/s, '
+              '{:.3g} MB output, eta {:.1f} s'.format(
+              len(runs), len(running), 100 * done / max(total, 1),
+              sum([st['steps_per_s'] for st in running]),
+              sum([st['output_bytes'] for st in runs]) / 2**20,
+              max([st['eta'] for st in running] + [0])))
+    else:
+        print('no status files (run swarmdyn with progress > 0)')
+    sys.stdout.flush()
+    return len(running)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='progress of swarmdyn runs')
+    parser.add_argument('paths', nargs='*', default=['.'],
+                        help='directories with progress_*.dat or status files')
+    parser.add_argument('--interval', type=float, default=0,
+                        help='repeat every interval seconds until no run is running')
+    parser.add_argument('--straggler', type=float, default=3,
+                        help='straggler: eta > straggler x median eta')
+    args = parser.parse_args()
+    while True:
+        running = report(args.paths, args.straggler)
+        if args.interval <= 0 or running == 0:
+            break
+        time.sleep(args.interval)
+        print('')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
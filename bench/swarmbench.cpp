@@ -0,0 +1,482 @@
+/*  SwarmBench
+    microbenchmarks of the core kernels of SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Build: make bench, run: ./swarmbench [-o bench.json] [-r trials]
+//        [-s min. seconds per trial] [-f name filter] [-q (quick: N<=1000)]
+// Every case is set up from a fixed seed (BENCH_SEED): agents initialized
+// (IC=0) and integrated for BENCH_WARMUP steps w/o predator. A trial times
+// `reps` calls of the kernel (reps calibrated once so that a trial takes
+// >= min. seconds), untimed preparation between calls restores the input.
+// Reported per case: time per call over the trials (mean, std, min,
+// median) and per item (agent, pair, ...) -> JSON (-o) and table (stdout).
+#include "swarmdyn.h"
+#include <omp.h>
+#include <unistd.h>     // gethostname, rmdir
+#include <functional>
+
+#define BENCH_SEED 1234
+#define BENCH_WARMUP 200
+
+// the generator used by Step (swarmdyn.cpp)
+extern gsl_rng *r;
+
+struct bench_result{
+    std::string name;
+    std::string variant;
+    unsigned int N;
+    int BC;
+    unsigned long long items;   // per call
+    unsigned int reps;          // calls per trial
+    std::vector<double> trial;  // seconds per call
+};
+typedef struct bench_result bench_result;
+
+struct bench_suite{
+    unsigned int trials;
+    double min_time;            // seconds per trial
+    std::string filter;
+    std::string location;       // scratch directory of the output kernels
+    gsl_rng *rng;
+    std::vector<bench_result> results;
+};
+typedef struct bench_suite bench_suite;
+
+
+// params as from the command line of a typical run (SwarmDynByPy.py)
+// without predator, output to S.location
+void SetupSystem(bench_suite &S, params &SP, std::vector<particle> &a,
+                 unsigned int N, int BC, int out_h5=0)
+{
+    double side = sqrt(N) * 1.5;    // of the initial square (IC=0, rep_range=0.5)
+    double L = (BC == BCElasticCircle::id || BC == BCInelasticCircle::id) ? 1.5 * side : side;
+    std::vector<std::string> args = {"swarmbench",
+        "-L", std::to_string(L), "-N", std::to_string(N), "-n", "0",
+        "-x", "1", "-X", "1", "-D", "0.02", "-b", "2.51", "-f", "7",
+        "-e", "10", "-S", "5", "-h", "0.5", "-a", "4", "-r", "10",
+        "-H", "110", "-A", "3.3", "-R", "110", "-o", "0.03", "-J", std::to_string(out_h5),
+        "-d", "0.001", "-t", "1", "-B", std::to_string(BC), "-I", "0",
+        "-m", "1", "-c", "4", "-T", "0", "-O", "5", "-G", "3", "-E", "xx",
+        "-Q", "0.8", "-u", "0.121", "-Y", "1", "-l", S.location};
+    std::vector<char *> argv;
+    for (unsigned int i=0; i<args.size(); i++)
+        argv.push_back(&args[i][0]);
+    SetCoreParameters(&SP);
+    ParseParameters(argv.size(), &argv[0], &SP);
+    InitSystemParameters(&SP);
+    gsl_rng_set(S.rng, BENCH_SEED);
+    a.assign(N, particle());
+    InitSystem(a, SP);
+    ResetSystem(a, &SP, false, S.rng);
+    SP.r = S.rng;
+    InitRNGBuffer(SP.rng, S.rng, 4096);
+    std::vector<predator> none;
+    StepFunction step = SelectStep(SP.BC, SP.sfm);
+    for (int s=0; s<BENCH_WARMUP; s++)
+        step(s, a, &SP, none);
+}
+
+
+void FreeSystem(params &SP)
+{
+    FreeVoronoiScratch(SP.scratch.vor);
+    SP.scratch.vor = NULL;
+    FreeBurstSampler(SP.bursts);
+}
+
+
+// all agents start a burst -> all compute their interactions
+void AllBursting(std::vector<particle> &a, params &SP)
+{
+    for (unsigned int i=0; i<a.size(); i++){
+        a[i].bin_step = SP.burst_steps;
+        a[i].NN.resize(0);
+    }
+}
+
+
+bool Selected(bench_suite &S, std::string name)
+{
+    return S.filter == "0" || name.find(S.filter) != std::string::npos;
+}
+
+
+// times kernel() (prepare() before each call, untimed)
+void Run(bench_suite &S, std::string name, std::string variant,
+         unsigned int N, int BC, unsigned long long items,
+         std::function<void()> prepare, std::function<void()> kernel)
+{
+    typedef std::chrono::steady_clock clock;
+    bench_result R;
+    R.name = name;
+    R.variant = variant;
+    R.N = N;
+    R.BC = BC;
+    R.items = items;
+    // calibration (1st call also warms caches and buffers)
+    double t1 = 0;
+    unsigned int calls = 0;
+    while (t1 < 0.1 * S.min_time || calls < 2){
+        prepare();
+        clock::time_point t0 = clock::now();
+        kernel();
+        t1 += std::chrono::duration<double>(clock::now() - t0).count();
+        calls++;
+    }
+    t1 /= calls;
+    R.reps = std::max(1., ceil(S.min_time / t1));
+    for (unsigned int t=0; t<S.trials; t++){
+        double sum = 0;
+        for (unsigned int k=0; k<R.reps; k++){
+            prepare();
+            clock::time_point t0 = clock::now();
+            kernel();
+            sum += std::chrono::duration<double>(clock::now() - t0).count();
+        }
+        R.trial.push_back(sum / R.reps);
+    }
+    std::vector<double> sorted = R.trial;
+    std::sort(sorted.begin(), sorted.end());
+    double mean = 0;
+    for (unsigned int t=0; t<sorted.size(); t++)
+        mean += sorted[t];
+    mean /= sorted.size();
+    printf("%-24s %-14s %6d %3d %10.3f us %8.2f ns/item %6.1f%%\n",
+           name.c_str(), variant.c_str(), N, BC, mean * 1e6,
+           mean * 1e9 / std::max(1ULL, items),
+           100 * (sorted.back() - sorted[0]) / mean);
+    fflush(stdout);
+    S.results.push_back(R);
+}
+
+
+// kernels depending on the boundary policy (BC=0: periodic, BC=6: tank)
+template<class BCP>
+void BenchBC(bench_suite &S, unsigned int N)
+{
+    if (!Selected(S, "IntCalcPrey") && !Selected(S, "SFM_4Zone") &&
+        !Selected(S, "InteractionVoronoiF2F") && !Selected(S, "InteractionVoronoiF2FP") &&
+        !Selected(S, "ParticleBurstCoast"))
+        return;
+    params SP;
+    std::vector<particle> a;
+    int BC = BCP::id;
+    SetupSystem(S, SP, a, N, BC);
+    std::vector<predator> none;
+
+    // interaction partners of all agents (input of IntCalcPrey, SFM4Zone)
+    AllBursting(a, SP);
+    Interaction<BCP, SFM4Zone>(a, &SP, none, false);
+    std::vector< std::vector<unsigned int> > partners(a.size());
+    std::vector<double> dist;
+    unsigned long long pairs = 0;
+    for (unsigned int i=0; i<a.size(); i++){
+        partners[i] = a[i].NN;
+        pairs += a[i].NN.size();
+        for (unsigned int k=0; k<a[i].NN.size(); k++)
+            dist.push_back(CalcDist(a[i].x, a[a[i].NN[k]].x, SP.BC, SP.sizeL));
+    }
+
+    if (Selected(S, "IntCalcPrey"))
+        Run(S, "IntCalcPrey", "voronoi_pairs", N, BC, pairs,
+            [&](){ AllBursting(a, SP); },
+            [&](){
+                for (unsigned int i=0; i<a.size(); i++)
+                    for (unsigned int k=0; k<partners[i].size(); k++)
+                        IntCalcPrey<BCP, SFM4Zone>(a, i, partners[i][k], &SP, true);
+            });
+    if (Selected(S, "SFM_4Zone")){
+        volatile double sink = 0;
+        Run(S, "SFM_4Zone", "voronoi_pairs", N, BC, dist.size(),
+            [](){},
+            [&](){
+                double w[3];
+                double sum = 0;
+                double inf = std::numeric_limits<double>::infinity();
+                for (unsigned int k=0; k<dist.size(); k++){
+                    SFM4Zone::Weights(&SP, dist[k], inf, w);
+                    sum += w[0] + w[1] + w[2];
+                }
+                sink = sum;
+            });
+    }
+    if (Selected(S, "InteractionVoronoiF2F"))
+        Run(S, "InteractionVoronoiF2F", "all_bursting", N, BC, N,
+            [&](){ AllBursting(a, SP); },
+            [&](){ Interaction<BCP, SFM4Zone>(a, &SP, none, false); });
+    if (Selected(S, "InteractionVoronoiF2FP")){
+        std::vector<predator> preds(1);
+        InitPredator(preds);
+        CreatePredator(a, &SP, preds[0], S.rng);
+        Run(S, "InteractionVoronoiF2FP", "all_bursting", N, BC, N,
+            [&](){
+                AllBursting(a, SP);
+                preds[0].NNset.clear();
+                preds[0].NN.resize(0);
+            },
+            [&](){ Interaction<BCP, SFM4Zone>(a, &SP, preds, true); });
+    }
+    if (Selected(S, "ParticleBurstCoast")){
+        // agents spread over the burst-coast cycle (burst start, bursting,
+        // coasting with a new interval), restored before each call:
+        // otherwise almost all agents coast after the 1st call
+        std::vector<particle> a0 = a;
+        for (unsigned int i=0; i<a0.size(); i++){
+            a0[i].bin_step = i % (SP.burst_steps + 1);
+            a0[i].steps_till_burst = a0[i].bin_step;
+        }
+        Run(S, "ParticleBurstCoast", "staggered", N, BC, N,
+            [&](){ a = a0; },
+            [&](){
+                for (unsigned int i=0; i<a.size(); i++)
+                    ParticleBurstCoast<BCP>(a[i], &SP, S.rng);
+            });
+    }
+    FreeSystem(SP);
+}
+
+
+// Boundary of agents scattered over and beyond the arena
+void BenchBoundary(bench_suite &S, unsigned int N, int BC)
+{
+    params SP;
+    std::vector<particle> a;
+    SetupSystem(S, SP, a, N, BC);
+    bool circle = (BC == BCElasticCircle::id || BC == BCInelasticCircle::id);
+    double lo = (circle) ? -1.25 * SP.sizeL : -0.25 * SP.sizeL;
+    double hi = 1.25 * SP.sizeL;
+    if (BC < 0){    // open: sizeL is only a placeholder
+        lo = 0;
+        hi = 1;
+    }
+    for (unsigned int i=0; i<a.size(); i++){
+        a[i].x[0] = lo + (hi - lo) * gsl_rng_uniform(S.rng);
+        a[i].x[1] = lo + (hi - lo) * gsl_rng_uniform(S.rng);
+    }
+    std::vector<particle> a0 = a;
+    Run(S, "Boundary", "scattered", N, BC, N,
+        [&](){
+            for (unsigned int i=0; i<a.size(); i++){
+                a[i].x = a0[i].x;
+                a[i].v = a0[i].v;
+            }
+        },
+        [&](){
+            for (unsigned int i=0; i<a.size(); i++)
+                Boundary(a[i], SP.sizeL, SP.BC);
+        });
+    FreeSystem(SP);
+}
+
+
+// wall avoidance of the circular tank (BC=6)
+void BenchClosestForceDirection(bench_suite &S, unsigned int N)
+{
+    params SP;
+    std::vector<particle> a;
+    int BC = BCInelasticCircle::id;
+    SetupSystem(S, SP, a, N, BC);
+    for (unsigned int i=0; i<a.size(); i++){
+        double phi = 2 * M_PI * gsl_rng_uniform(S.rng);
+        a[i].force[0] = SP.env_strength * cos(phi);
+        a[i].force[1] = SP.env_strength * sin(phi);
+    }
+    volatile double sink = 0;
+    Run(S, "closestForceDirection", "random_force", N, BC, N,
+        [](){},
+        [&](){
+            double sum = 0;
+            for (unsigned int i=0; i<a.size(); i++)
+                sum += closestForceDirection(a[i], &SP);
+            sink = sum;
+        });
+    FreeSystem(SP);
+}
+
+
+// predator at the center of mass, kills restored after each call
+void BenchPredKill(bench_suite &S, unsigned int N, int kill_mode)
+{
+    params SP;
+    std::vector<particle> a;
+    int BC = BCPeriodic::id;
+    SetupSystem(S, SP, a, N, BC);
+    SP.pred_kill = kill_mode;
+    std::vector<predator> preds(1);
+    InitPredator(preds);
+    std::vector<int> all(0);
+    GetCenterOfMass(a, &SP, all, preds[0].x);
+    Run(S, "PredKill", "mode_" + std::to_string(kill_mode), N, BC, N,
+        [&](){
+            for (unsigned int i=0; i<a.size(); i++)
+                a[i].dead = false;
+            SP.Ndead = 0;
+            BuildCellGrid(SP.grid, a, &SP);
+        },
+        [&](){ PredKill(a, preds[0], &SP, S.rng); });
+    FreeSystem(SP);
+}
+
+
+// output kernels (NN from a full interaction for Out_swarm)
+void BenchOutput(bench_suite &S, unsigned int N)
+{
+    if (!Selected(S, "Out_swarm") && !Selected(S, "AreaConvexHull") &&
+        !Selected(S, "WriteParticles"))
+        return;
+    params SP;
+    std::vector<particle> a;
+    int BC = BCInelasticCircle::id;
+    SetupSystem(S, SP, a, N, BC);
+    std::vector<predator> none;
+    AllBursting(a, SP);
+    Interaction<BCInelasticCircle, SFM4Zone>(a, &SP, none, false);
+    volatile double sink = 0;
+    if (Selected(S, "Out_swarm"))
+        Run(S, "Out_swarm", "all_agents", N, BC, N,
+            [](){},
+            [&](){ sink = Out_swarm(a, SP)[1]; });
+    if (Selected(S, "AreaConvexHull")){
+        std::vector<int> nodes(a.size());
+        std::iota(nodes.begin(), nodes.end(), 0);
+        Run(S, "AreaConvexHull", "all_agents", N, BC, N,
+            [](){},
+            [&](){ sink = AreaConvexHull(a, nodes); });
+    }
+    if (Selected(S, "WriteParticles")){
+        // txt: a new file per call (the run appends to an open-per-call file)
+        std::string f_txt = SP.location + "part_xx.dat";
+        SP.out_h5 = 0;
+        Run(S, "WriteParticles", "txt", N, BC, N,
+            [&](){ remove(f_txt.c_str()); },
+            [&](){ WriteParticles<particle>(a, SP, "part", 0); });
+        remove(f_txt.c_str());
+        // h5: dataset of 32 output steps, re-created when full
+        std::string f_h5 = SP.location + "out_xx.h5";
+        SP.out_h5 = 1;
+        SP.outstep = 0;
+        SP.total_outstep = 32;
+        unsigned int outstep = SP.total_outstep;
+        Run(S, "WriteParticles", "h5", N, BC, N,
+            [&](){
+                if (outstep == SP.total_outstep){
+                    remove(f_h5.c_str());
+                    outstep = 0;
+                }
+            },
+            [&](){ WriteParticles<particle>(a, SP, "part", outstep++); });
+        remove(f_h5.c_str());
+    }
+    FreeSystem(SP);
+}
+
+
+void WriteJSON(bench_suite &S, std::string fname)
+{
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    FILE *fp = fopen(fname.c_str(), "w");
+    if (fp == NULL){
+        std::cout<< "can not write " << fname << std::endl;
+        return;
+    }
+    fprintf(fp, "{\n  \"suite\": \"swarmbench\",\n  \"host\": \"%s\",\n", host);
+    fprintf(fp, "  \"seed\": %d,\n  \"warmup_steps\": %d,\n", BENCH_SEED, BENCH_WARMUP);
+    fprintf(fp, "  \"trials\": %u,\n  \"min_time\": %g,\n  \"threads\": %d,\n",
+            S.trials, S.min_time, omp_get_max_threads());
+    fprintf(fp, "  \"results\": [\n");
+    for (unsigned int k=0; k<S.results.size(); k++){
+        bench_result &R = S.results[k];
+        std::vector<double> sorted = R.trial;
+        std::sort(sorted.begin(), sorted.end());
+        unsigned int n = sorted.size();
+        double mean = 0;
+        for (unsigned int t=0; t<n; t++)
+            mean += sorted[t];
+        mean /= n;
+        double var = 0;
+        for (unsigned int t=0; t<n; t++)
+            var += (sorted[t] - mean) * (sorted[t] - mean);
+        var = (n > 1) ? var / (n - 1) : 0;
+        double median = (n % 2) ? sorted[n/2] : 0.5 * (sorted[n/2 - 1] + sorted[n/2]);
+        fprintf(fp, "    {\"name\": \"%s\", \"variant\": \"%s\", \"N\": %u, \"BC\": %d, "
+                "\"items\": %llu, \"reps\": %u,\n     \"mean_ns\": %.6g, \"std_ns\": %.6g, "
+                "\"min_ns\": %.6g, \"median_ns\": %.6g, \"max_ns\": %.6g, \"cv\": %.4g, "
+                "\"ns_per_item\": %.6g,\n     \"trials_ns\": [",
+                R.name.c_str(), R.variant.c_str(), R.N, R.BC, R.items, R.reps,
+                mean * 1e9, sqrt(var) * 1e9, sorted[0] * 1e9, median * 1e9,
+                sorted.back() * 1e9, (mean > 0) ? sqrt(var) / mean : 0,
+                mean * 1e9 / std::max(1ULL, R.items));
+        for (unsigned int t=0; t<n; t++)
+            fprintf(fp, "%s%.6g", (t > 0) ? ", " : "", R.trial[t] * 1e9);
+        fprintf(fp, "]}%s\n", (k + 1 < S.results.size()) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+}
+
+
+int main(int argc, char **argv)
+{
+    bench_suite S;
+    S.trials = atoi(getCmdOption(argv, argv+argc, "-r"));
+    S.min_time = atof(getCmdOption(argv, argv+argc, "-s"));
+    S.filter = getCmdOption(argv, argv+argc, "-f");
+    std::string fout = getCmdOption(argv, argv+argc, "-o");
+    bool quick = std::find(argv, argv+argc, std::string("-q")) != argv+argc;
+    if (S.trials < 2)
+        S.trials = 10;
+    if (S.min_time <= 0)
+        S.min_time = 0.02;
+    if (fout == "0")
+        fout = "bench.json";
+    char tmpl[] = "/tmp/swarmbench_XXXXXX";
+    if (mkdtemp(tmpl) == NULL){
+        std::cout<< "no scratch directory in /tmp" << std::endl;
+        return 1;
+    }
+    S.location = std::string(tmpl) + "/";
+    S.rng = gsl_rng_alloc(gsl_rng_mt19937);
+    r = S.rng;
+
+    std::vector<unsigned int> Ns = {100, 1000, 10000};
+    if (quick)
+        Ns = {100, 1000};
+    printf("%-24s %-14s %6s %3s %13s %16s %7s\n", "kernel", "variant", "N", "BC",
+           "time/call", "time/item", "spread");
+    for (unsigned int n=0; n<Ns.size(); n++){
+        BenchBC<BCPeriodic>(S, Ns[n]);
+        BenchBC<BCInelasticCircle>(S, Ns[n]);
+    }
+    if (Selected(S, "Boundary"))
+        for (int BC=-1; BC<=6; BC++)    // BC=7 needs an arena file
+            BenchBoundary(S, 1000, BC);
+    if (Selected(S, "closestForceDirection"))
+        BenchClosestForceDirection(S, 1000);
+    if (Selected(S, "PredKill"))
+        for (int mode=1; mode<=4; mode++)
+            BenchPredKill(S, 1000, mode);
+    for (unsigned int n=0; n<Ns.size(); n++)
+        BenchOutput(S, Ns[n]);
+
+    WriteJSON(S, fout);
+    rmdir(tmpl);
+    gsl_rng_free(S.rng);
+    std::cout<< "-> " << fout << std::endl;
+    return 0;
+}
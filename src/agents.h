@@ -21,6 +21,12 @@
 #ifndef agents_H
 #define agents_H
 #include "common_defines.h"
+#include "kinematics.h"
+#include "burst_intervals.h"
+#include "rng_buffer.h"
+#include "phase_timers.h"
+#include "voronoi_tiles.h"
+#include "engine_select.h"
 #include <gsl/gsl_rng.h>
 #include <H5Cpp.h>      // for hdf5 output
 #include <set>
@@ -79,12 +85,55 @@ struct predator{
 };
 typedef struct predator predator;
 
+// uniform grid (linked-cell list) of agent positions for nearest neighbor
+// and radius queries (periodic for BC=0), see BuildCellGrid
+struct cellgrid{
+    int nx, ny;             // # of cells in x and y
+    double cs;              // cell size
+    double x0, y0;          // lower left corner of grid
+    bool periodic;
+    std::vector<int> head;  // first agent in cell (-1 if empty)
+    std::vector<int> next;  // next agent in same cell (-1 if last)
+    std::vector<int> count; // # of agents in cell
+};
+typedef struct cellgrid cellgrid;
+
+// neighbors of one focal agent as structure of arrays (input of SFMBatch)
+struct neighbor_batch{
+    std::vector<int> nn;            // index of the neighbor
+    std::vector<double> edge;       // length of shared voronoi edge
+    std::vector<double> u0, u1;     // unit vector focal -> neighbor
+    std::vector<double> v0, v1;     // velocity of neighbor
+    std::vector<double> dist;
+    std::vector<double> used;
+};
+typedef struct neighbor_batch neighbor_batch;
+
+// buffers of the step reused every step: after warm-up (all reached their
+// maximal size) a step without predator does not allocate (alloc_counter.h)
+struct step_scratch{
+    std::vector<double> force, hvec;    // ParticleBurstCoast
+    std::vector<char> need;             // agents starting a burst (voronoi)
+    std::vector<int> bursting;          // agents starting a burst (topological)
+    std::vector<double> x, y;           // points of the neighbor search
+    std::vector<int> id;                //  (+ copies for periodic BC)
+    neighbor_list NL;
+    voronoi_scratch *vor;               // buffers of voronoi_tiles.cpp
+    std::vector<neighbor_batch> batch;  // 1 per thread
+    std::vector<int> shell_of;          // PredDetection: distance shell of a cell (-1: none)
+    std::vector<unsigned int> shell_start;  // cells of shell k:
+    std::vector<int> shell_cells;       //  shell_cells[shell_start[k]] ... [shell_start[k+1]-1]
+};
+typedef struct step_scratch step_scratch;
+
+
 // data structure for system parameters, and auxiliary variables
 struct params{
 
     std::string location;   // path of output-files
     std::string fileID;     // name of output-files
     unsigned int N;                  // number of agents
+    unsigned int Nrep;      // number of independent replicates integrated in lockstep (ensemble mode if > 1)
     int Npred;              // 1 if predator, 0 if not
     int Ndead;              // # of dead/killed agents
     double sizeL;           // system size
@@ -94,12 +143,21 @@ struct params{
     double soc_strength;    // social strength
     double env_strength;    // environmental strength
     double burst_rate;    // alignment strength
+    int burst_dist;         // inter-burst interval distribution 0: geometric, 1: gamma, 2: lognormal, 3: empirical
+    double burst_shape;     // shape of gamma / sigma of lognormal intervals
+    std::string burst_file; // empirical intervals (burst_dist=3), see burst_intervals.h
+    burst_sampler bursts;   // sampler of the # of steps till the next burst
 
     double prob_social;    // social rep. strength
 
     double rep_range;       // repulsion range
     double alg_range;       // alignment range
     double att_range;       // attraction range
+    unsigned int kNN;       // topological interaction with kNN nearest neighbors (0: voronoi)
+    int engine;             // if kNN=0: 0: voronoi neighbors, 1: global (all pairs, metric zones), -1: auto (voronoi, vor_threads by cost model)
+    int sfm;                // social force model 0: 4-zone, 1: smooth zones, 2: voronoi-edge weighted
+    unsigned int vor_threads; // >0: voronoi from tiled triangulations with vor_threads threads (voronoi_tiles.h)
+    unsigned int sort_every; // re-sort agents along a Hilbert curve every sort_every steps (0: never)
 
     double alphaTurn;
     double flee_range;      // flee range
@@ -112,6 +170,8 @@ struct params{
     double output;          // output time in natural units
 
     int BC;                 // switch for boundary conditions
+    std::string arena_file; // arena geometry (BC=7), see arena.h
+    double arena_res;       // node spacing of the signed distance field of the arena
     int IC;                 // switch for initial conditions
     int N_confu;// determines if the predator 1: strictly moves relative to COM, 2: follows the COM, 3: adjust start position to hit com with straight move
     int pred_kill;         // if predator kills prey or flies through
@@ -127,6 +187,11 @@ struct params{
     bool out_mean;          // derived from output_mode
     bool out_particle;      // derived from output_mode
     int out_h5;             // switch for ouput data format (txt, HDF5)
+    int timing;             // 1: time the phases of the step, 2: + hardware counters (phase_timers.h)
+    unsigned int trace_every; // >0: chrome trace of every trace_every-th step/output (trace_fileID.json)
+    int alloc_check;        // >0: checks that steps after alloc_check warm-up steps (w/o predator) do not allocate
+    double progress;        // >0: progress report every progress seconds of wall time (progress.h)
+    unsigned long seed;     // >0: seed of the random numbers (reproducible runs), 0: from the clock
     unsigned int outstep;       // current output step (needed for hdf5)
     unsigned int outstep_pred;  // current output step (needed for hdf5)
     unsigned int total_outstep; // total Nr of output steps
@@ -143,8 +208,14 @@ struct params{
     double burst_duration;
     unsigned int burst_steps;      // steps which prey stays in bin_mode
     double beta;            // relaxation rate of velocity along heading
+    propagator prop;        // exact propagators of the burst-coast kinematics (tables)
 
     gsl_rng *r;
+    rngbuffer rng;          // block-generated uniforms for the step (see rng_buffer.h)
+    cellgrid grid;          // prey positions, rebuild each step if predator is active
+    phase_timers timers;    // time per phase (on if timing)
+    step_scratch scratch;   // reused every step (see step_scratch)
+    engine_model engines;   // cost model of the voronoi engines (engine=-1)
 };
 typedef struct params params;
 
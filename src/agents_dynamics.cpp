@@ -20,17 +20,16 @@
 */
 #include "agents_dynamics.h"
 
+template<class BCP>
 void draw_social_or_environmental_force(particle &a, params *ptrSP,
                                         gsl_rng *r, std::vector<double> &force,
                                         std::vector<double> &hvec, double &force_mag)
 {
         double helper = 0;
-        double dt = ptrSP->dt;
         double lphi = 0.0;
         double sizeL = ptrSP->sizeL;
-        double beta = ptrSP->beta;
         double prob_social = ptrSP->prob_social;
-        double draw_social = gsl_rng_uniform(r);
+        double draw_social = RandUniform(ptrSP->rng, RNG_BURST);
         
         if(draw_social <= prob_social)
         {
@@ -47,13 +46,15 @@ void draw_social_or_environmental_force(particle &a, params *ptrSP,
                 if(a.force_alg[0] != 0 || a.force_alg[1] != 0)
                 {
                     // hvec = vec_set_mag(a.force_alg, 1);
-                    hvec = vec_set_mag(a.force_alg, a.counter_alg);
+                    hvec = a.force_alg;
+                    vec_set_mag221(hvec, a.counter_alg);
                     vec_add221(force, hvec);
                 }
                 if(a.force_att[0] != 0 || a.force_att[1] != 0)
                 {
                     // hvec = vec_set_mag(a.force_att, 1);
-                    hvec = vec_set_mag(a.force_att, a.counter_att);
+                    hvec = a.force_att;
+                    vec_set_mag221(hvec, a.counter_att);
                     vec_add221(force, hvec);
                 }
             }
@@ -61,7 +62,7 @@ void draw_social_or_environmental_force(particle &a, params *ptrSP,
             // normalize:
             if(force[0] != 0 || force[1] != 0)
             {
-                force = vec_set_mag(force, 1);
+                vec_set_mag221(force, 1);
             }
             // if no social-force -> swim straight
             else
@@ -76,23 +77,23 @@ void draw_social_or_environmental_force(particle &a, params *ptrSP,
             if(a.counter_flee > 0)
             {
                 force = a.force_flee;
-                force = vec_set_mag(force, 1);
+                vec_set_mag221(force, 1);
             }
             else
             {
                 force_mag = ptrSP->env_strength;
-                lphi = 2 * M_PI * gsl_rng_uniform(r);
+                lphi = 2 * M_PI * RandUniform(ptrSP->rng, RNG_BURST);
                 // random direction only forwards:
-                // lphi = a.phi + (M_PI * gsl_rng_uniform(r) - M_PI / 2);
+                // lphi = a.phi + (M_PI * RandUniform(ptrSP->rng, RNG_BURST) - M_PI / 2);
                 force[0] = cos(lphi);
                 force[1] = sin(lphi);
             }
         }
         
-        // WALL: only if not periodic boundary conditions
-        if(ptrSP->BC >= 5)
+        // WALL: only for circular tank
+        if(BCP::circle)
         {
-            force = vec_set_mag(force, force_mag);
+            vec_set_mag221(force, force_mag);
             a.force = force;
             
             //------------------ WALL collision avoidance ------------------
@@ -102,11 +103,12 @@ void draw_social_or_environmental_force(particle &a, params *ptrSP,
             // 1: Estimate future position x_fut  
             // 2: if x_fut outside of Tank use the force closest to the intended force 
             //      which ensures that the agent is inside the tank at the next burst
-            std::vector<double> x_fut = predictXatNextBurst(a.x, a.v, a.force, 
-                                                            dt * ptrSP->burst_steps,
-                                                            dt * a.steps_till_burst,
-                                                            beta);
-            double r_fut = vec_length(x_fut);
+            double cv, cf;
+            predictCoefficients(ptrSP->prop, a.steps_till_burst, cv, cf);
+            double x_fut[2];
+            for(unsigned int i=0; i<2; i++)
+                x_fut[i] = a.x[i] + cv * a.v[i] + cf * a.force[i];
+            double r_fut = sqrt(x_fut[0] * x_fut[0] + x_fut[1] * x_fut[1]);
             
             if(r_fut > sizeL - 2)
             {
@@ -116,17 +118,35 @@ void draw_social_or_environmental_force(particle &a, params *ptrSP,
             }
         }
         
-        force = vec_set_mag(force, force_mag);
+        // WALL: arbitrary arena, same as above with SDF lookups
+        if(BCP::sdf)
+        {
+            vec_set_mag221(force, force_mag);
+            double cv, cf;
+            predictCoefficients(ptrSP->prop, a.steps_till_burst, cv, cf);
+            double P[2] = {a.x[0] + cv * a.v[0], a.x[1] + cv * a.v[1]};
+            double g[2];
+            if(ArenaDist(*BCArena::field, P[0] + cf * force[0],
+                         P[1] + cf * force[1], g) < 2)
+            {
+                helper = ArenaForceDirection(*BCArena::field, P, cf * force_mag,
+                                             atan2(force[1], force[0]));
+                force[0] = force_mag * cos(helper);
+                force[1] = force_mag * sin(helper);
+            }
+        }
+        
+        vec_set_mag221(force, force_mag);
         a.force = force;
 }
 
 bool overshoot_check(particle &a, std::vector<double> &force, double &force_mag, double &lphi) 
 { 
-    std::vector<double> new_u {cos(lphi), sin(lphi)};
+    double new_u[2] = {cos(lphi), sin(lphi)};
     
     double angForceV0 = acos(vec_dot(a.u, force) / force_mag);
-    double angForceV1 = acos(vec_dot(new_u, force) / force_mag);
-    double angV0V1 = acos(vec_dot(new_u, a.u));
+    double angForceV1 = acos((new_u[0] * force[0] + new_u[1] * force[1]) / force_mag);
+    double angV0V1 = acos(new_u[0] * a.u[0] + new_u[1] * a.u[1]);
     
     bool OvershootI = (angForceV0 < angForceV1);
     bool OvershootII = not OvershootI and (angV0V1 > angForceV0);
@@ -136,21 +156,20 @@ bool overshoot_check(particle &a, std::vector<double> &force, double &force_mag,
     return overshoot;
 }
 
+template<class BCP>
 void consider_boundary(particle &a, params *ptrSP)
 {
-    int BC = ptrSP->BC;
-    double sizeL = ptrSP->sizeL;
-    
-    if(BC!=-1)
-    {
-        Boundary(a, sizeL, BC);
-    }
+    BCP::Apply(a, ptrSP->sizeL);
 }
 
+template<class BCP>
 void ParticleBurstCoast(particle &a, params *ptrSP, gsl_rng *r)
 {
-    std::vector<double> force(2);
-    std::vector<double> hvec(2);
+    // scratch of the step (no allocation), zeroed as new vectors
+    std::vector<double> &force = ptrSP->scratch.force;
+    std::vector<double> &hvec = ptrSP->scratch.hvec;
+    force.assign(2, 0);
+    hvec.assign(2, 0);
     
     double force_mag = ptrSP->soc_strength;
     
@@ -159,7 +178,7 @@ void ParticleBurstCoast(particle &a, params *ptrSP, gsl_rng *r)
    
     if(first_burst)
     {
-        draw_social_or_environmental_force(a, ptrSP, r, force, hvec, force_mag);
+        draw_social_or_environmental_force<BCP>(a, ptrSP, r, force, hvec, force_mag);
     }
     else if(bursting)
     {
@@ -197,15 +216,17 @@ void ParticleBurstCoast(particle &a, params *ptrSP, gsl_rng *r)
     double forcev = force[0] * cos(lphi) + force[1] * sin(lphi);
     
     double dt = ptrSP->dt;
-    double beta = ptrSP->beta;
-    // a.vproj += (-beta * vproj * vproj * vproj + forcev) * dt;
-    a.vproj += (-beta * vproj + forcev) * dt;
+    // exact propagation over dt (instead of Euler: a.vproj += (-beta * vproj + forcev) * dt)
+    const propagator &P = ptrSP->prop;
+    a.vproj = P.decay[1] * vproj + P.gain[1] * forcev;
+    double dx = P.gain[1] * vproj + P.disp[1] * forcev;
     
     // a.vproj += rnv;
     // prevents F of swimming back
     if (a.vproj < 0)
     {
       a.vproj = 0.001;
+      dx = a.vproj * dt;
       lphi += M_PI / 2;
     }
     
@@ -231,8 +252,8 @@ void ParticleBurstCoast(particle &a, params *ptrSP, gsl_rng *r)
     // Move particles with speed in units of [vel.al. range. / time]
     a.v[0] = a.vproj*a.u[0];
     a.v[1] = a.vproj*a.u[1];
-    a.x[0] += a.v[0]*dt;
-    a.x[1] += a.v[1]*dt;
+    a.x[0] += dx*a.u[0];
+    a.x[1] += dx*a.u[1];
     
     // Reset all forces
     a.force_rep[0] = a.force_rep[1] = 0.0;
@@ -244,229 +265,85 @@ void ParticleBurstCoast(particle &a, params *ptrSP, gsl_rng *r)
     a.counter_att = 0;
     a.counter_flee = 0;
     
-    consider_boundary(a, ptrSP);
+    consider_boundary<BCP>(a, ptrSP);
     
     
      if ( a.steps_till_burst == 0 )
      {
         a.bin_step = ptrSP->burst_steps;
-        double draw_update;
-        unsigned int steps = 1;
-        double burst_rate = ptrSP->burst_rate;
-        unsigned int max_steps = 5 / (burst_rate * dt); // 1 burst takes on average 1/burst_rate times which are 1/ (burst_rate * dt) steps
-        while(a.steps_till_burst == 0)
-        {
-            draw_update = gsl_rng_uniform(r);
-            if (draw_update <= burst_rate * dt)
-            {
-                a.steps_till_burst = steps;
-            }
-            if (steps > max_steps )// break condition (no infinite loops)
-            { 
-                a.steps_till_burst = steps;   
-            }
-            steps += 1;
-        }
+        if (ptrSP->bursts.dist == 0)
+            a.steps_till_burst = GeometricInterval(ptrSP->bursts,
+                                                   RandUniform(ptrSP->rng, RNG_INTERVAL));
+        else
+            a.steps_till_burst = DrawStepsTillBurst(ptrSP, r);
     }
     
-    consider_boundary(a, ptrSP);
+    consider_boundary<BCP>(a, ptrSP);
 }
 
+template
+void ParticleBurstCoast<BCOpen>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCPeriodic>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCInelasticBox>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCElasticBox>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCPeriodicXElasticY>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCPeriodicXInelasticY>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCElasticCircle>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCInelasticCircle>(particle &a, params *ptrSP, gsl_rng *r);
+template
+void ParticleBurstCoast<BCArena>(particle &a, params *ptrSP, gsl_rng *r);
 
-template<class agent>
-void Boundary(agent &a, double sizeL,  int BC)
-{
-// Function for calculating boundary conditions
-// and update agent position and velocity accordingly
-double tx;
-double dphi=0.1;
-double tmpphi;
-double dx=0.0;
-double dist2cen;
-double diff;
-
-std::vector<double> hv(2);
-std::vector<double> wall_normal = a.x;
-
-// -1 is Open boundary condition
-switch (BC)
-{
-    case 0:
-        // Periodic boundary condition
-        a.x[0] = fmod(a.x[0] + sizeL, sizeL);
-        a.x[1] = fmod(a.x[1] + sizeL, sizeL);
-        break;
-    // TODO: any case which changes the velocity should also change u, phi
-    case 1:
-        // Inelastic box boundary condition
-        if(a.x[0]>sizeL)
-        {
-            a.x[0]=0.9999*sizeL;
-            if(a.v[1]>0.)
-                tmpphi=(0.5+dphi)*M_PI;
-            else
-                tmpphi=-(0.5+dphi)*M_PI;
-
-            a.v[0]=cos(tmpphi);
-            a.v[1]=sin(tmpphi);
-        }
-        else if(a.x[0]<0)
-        {
-            a.x[0]=0.0001;
-            
-            if(a.v[1]>0.)
-            {
-                tmpphi=(0.5-dphi)*M_PI;
-            }
-            else
-            {
-                tmpphi=-(0.5-dphi)*M_PI;
-            }
-
-            a.v[0]=cos(tmpphi);
-            a.v[1]=sin(tmpphi);
-        }
-        if(a.x[1]>sizeL)
-        {
-            a.x[1]=0.9999*sizeL;
-            if(a.v[0]>0.)
-                tmpphi=-dphi;
-            else
-                tmpphi=M_PI+dphi;
-
-            a.v[0]=cos(tmpphi);
-            a.v[1]=sin(tmpphi);
-
-        }
-        else if(a.x[1]<0)
-        {
-            a.x[1]=0.0001;
-            if(a.v[0]>0.)
-                tmpphi=dphi;
-            else
-                tmpphi=M_PI-dphi;
-
-            a.v[0]=cos(tmpphi);
-            a.v[1]=sin(tmpphi);
-        }
 
-        break;
-        
-    case 2:
-        // Elastic box boundary condition
-        if(a.x[0]>sizeL)
-        {
-            dx=2.*(a.x[0]-sizeL);
-            a.x[0]-=dx;
-            a.v[0]*=-1.;
-        }
-        else if(a.x[0]<0)
-        {
-            dx=2.*a.x[0];
-            a.x[0]-=dx;
-            a.v[0]*=-1.;
-        }
-        if(a.x[1]>sizeL)
-        {
-            dx=2.*(a.x[1]-sizeL);
-            a.x[1]-=dx;
-            a.v[1]*=-1.;
-        }
-        else if(a.x[1]<0)
-        {
-            dx=2.*a.x[1];
-            a.x[1]-=dx;
-            a.v[1]*=-1.;
-        }
-        break;
+unsigned int DrawStepsTillBurst(params *ptrSP, gsl_rng *r)
+{
+    // draws the # of steps till the next burst
+    // (default: at each step a burst is initiated with probability burst_rate * dt)
+    return DrawBurstInterval(ptrSP->bursts, r);
+}
 
-    case 3:
-        // Periodic boundary condition in x
-        // Elastic  boundary condition in y
-        tx= fmod(a.x[0], sizeL);
-        if(tx < 0.0f)
-            tx += sizeL;
-        a.x[0]=tx;
 
-        if(a.x[1]>sizeL)
-        {
-            dx=2.*(a.x[1]-sizeL);
-            a.x[1]-=dx;
-            a.v[1]*=-1.;
-        }
-        else if(a.x[1]<0)
-        {
-            dx=2.*a.x[1];
-            a.x[1]-=dx;
-            a.v[1]*=-1.;
-        }
-        break;
-    case 4:
-        // Periodic boundary condition in x
-        // Inelastic  boundary condition in y
-        tx= fmod(a.x[0], sizeL);
-        if(tx < 0.0f)
-        {
-            tx += sizeL;
-        }
-        a.x[0]=tx;
+const arena *BCArena::field = NULL;
 
-        if(a.x[1]>sizeL)
-        {
-            dx=(a.x[1]-sizeL);
-            a.x[1]-=dx+0.0001;
-            a.v[1]=0.0;
-        }
-        else if(a.x[1]<0)
-        {
-            dx=a.x[1];
-            a.x[1]-=dx-0.0001;
-            a.v[1]=0.0;
-        }
-        break;
-        
-    case 5:
-        // Elastic circle boundary condition
-        dist2cen = vec_length(a.x);
-        diff = dist2cen - sizeL;
-        
-        if (diff > 0)
-        {
-            // 1. mirror the position at the circular wall
-            vec_mul221(wall_normal, 1 / dist2cen); // wall_normal = 1 * a.x / |a.x|
-            hv = vec_mul(wall_normal, - 2 * diff); // hv = wall_normal * 2 * diff
-            vec_add221(a.x, hv);
-            // 2. mirror the velocity at the circular wall
-            diff = vec_dot(wall_normal, a.v);
-            hv = vec_mul(wall_normal, - 2 * diff);
-            vec_add221(a.v, hv);
-            // 3. update rest of agent properties
-            a.u = vec_set_mag(a.v, 1);
-            a.phi = atan2(a.u[1], a.u[0]);
-        }
-        break;
-        
-    case 6:
-        // half-elastic circle boundary condition
-        dist2cen = vec_length(a.x);
-        diff = dist2cen - sizeL;
-        
-        if(diff > 0)
-        {
-            // 1. mirror the position at the circular wall
-            vec_mul221(wall_normal, 1 / dist2cen); // wall_normal = 1 * a.x / |a.x|
-            hv = vec_mul(wall_normal, - 2 * diff); // hv = wall_normal * 2 * diff
-            vec_add221(a.x, hv);
-            // 2. set velocity component normal to wall to 0
-            diff = vec_dot(wall_normal, a.v);
-            hv = vec_mul(wall_normal, -diff);
-            vec_add221(a.v, hv);
-            // vec_div221(a.v, 4);
-            // 3. update rest of agent properties
-            a.u = vec_set_mag(a.v, 1);
-            a.phi = atan2(a.u[1], a.u[0]);
-        }
-        break;
+template<class agent>
+void Boundary(agent &a, double sizeL,  int BC)
+{
+    // Function for calculating boundary conditions
+    // and update agent position and velocity accordingly
+    // (runtime dispatch to the BC-policies in boundary_conditions.h)
+    // -1 is Open boundary condition
+    switch (BC)
+    {
+        case 0:
+            BCPeriodic::Apply(a, sizeL);
+            break;
+        case 1:
+            BCInelasticBox::Apply(a, sizeL);
+            break;
+        case 2:
+            BCElasticBox::Apply(a, sizeL);
+            break;
+        case 3:
+            BCPeriodicXElasticY::Apply(a, sizeL);
+            break;
+        case 4:
+            BCPeriodicXInelasticY::Apply(a, sizeL);
+            break;
+        case 5:
+            BCElasticCircle::Apply(a, sizeL);
+            break;
+        case 6:
+            BCInelasticCircle::Apply(a, sizeL);
+            break;
+        case 7:
+            BCArena::Apply(a, sizeL);
+            break;
     }
 }
 
@@ -570,30 +447,18 @@ void MovePredator(predator &pred, std::vector<particle> &a, params *ptrSP, gsl_r
     
     if(ptrSP->pred_move == 0)
     {
-        double rnp = ptrSP->noisep * gsl_ran_gaussian(r, 1.0); //  ptrSP->noisep * gsl_ran_gaussian(r, 1.0);
+        double rnp = ptrSP->noisep * RandNormal(ptrSP->rng, RNG_PRED); //  ptrSP->noisep * gsl_ran_gaussian(r, 1.0);
         lphi = pred.phi;
         lphi +=  rnp * sqrt(ptrSP->pred_speed0); // to keep persistence length the same
         lphi = fmod(lphi, 2*M_PI);
     }
     // directly going for closest prey (no special dynamics)
+    // (ptrSP->grid must contain current prey positions, see Step)
     else
     {
-        std::vector<double> hv(2);
-        std::vector<double> minvec = CalcDistVec(pred.x, a[0].x, ptrSP->BC, ptrSP->sizeL); // pointing to a
-        
-        double mindist = vec_length(minvec);
-        
-        for(int i=1; i<a.size(); i++)
-        {
-            hv = CalcDistVec(pred.x, a[i].x, ptrSP->BC, ptrSP->sizeL); // pointing to a
-            double dist = vec_length(hv);
-            
-            if (dist < mindist)
-            {
-                mindist = dist;
-                minvec = hv;
-            }
-        }
+        double mindist;
+        int closest = GridNearest(ptrSP->grid, a, pred.x, ptrSP, mindist);
+        std::vector<double> minvec = CalcDistVec(pred.x, a[closest].x, ptrSP->BC, ptrSP->sizeL); // pointing to a
         lphi = atan2(minvec[1], minvec[0]);
         // std::vector<double> com(2);
         // std::vector<int> empty(0);
@@ -696,79 +561,44 @@ std::vector<double> predictXatNextBurst(std::vector<double> & x,
 }
 
 
-double forceChange2NotCollide(particle &a, params * ptrSP,
-                              double dphi)
-{
-    // change in force direction results in an inside position
-    // 1. It starts with an change of dphi
-    // 2. it repeatedly changes the force direction by dphi until it 
-    //      finds the first position inside the boundary
-    // 3. Now at each next step dphi is halfed 
-    // 4. if an an inside position is found it changes the force by -dphi
-    //      i.e. it makes the change smaller
-    // 5. if an an outside position is found it changes the force by +dphi
-    // 6. 2 break conditions exists: final resolution reached OR change = PI
-    double t_burst = ptrSP->dt * ptrSP->burst_steps;
-    double t_tnb = ptrSP->dt * a.steps_till_burst;
-    double friction = ptrSP->beta;
-    double force_mag = vec_length(a.force);
-    double forceAngle = atan2(a.force[1], a.force[0]);
-    double insideChange = M_PI;
-    
-    std::vector<double> force(2);
-    std::vector<double> x_anb(2);
-    
-    bool outside = true;
-    bool foundInsideAngle = false;
-   
-    double forceChange = dphi;
-    
-    while (fabs(forceChange) < M_PI and outside)
-    {
-        force[0] = force_mag * cos(forceAngle + forceChange);
-        force[1] = force_mag * sin(forceAngle + forceChange);
-        x_anb = predictXatNextBurst(a.x, a.v, force, t_burst, t_tnb, friction);
-        
-        double r_x = vec_length(x_anb);
-        
-        if(r_x < ptrSP->sizeL)
-        {
-            insideChange = forceChange;
-            foundInsideAngle = true;
-            outside = false;
-        }
-        if (foundInsideAngle)
-        {
-            dphi /= 2;
-        }
-        if(outside)
-        {
-            forceChange += dphi;
-        }
-        else if(fabs(dphi) > M_PI/64)
-        {
-            forceChange -= dphi;
-            outside = true;
-        }
-    }
-    
-    return insideChange;
-}
-
-
 double closestForceDirection(particle &a, params * ptrSP)
 {
+    // returns the force direction closest to the intended force a.force
+    // for which the predicted position at the next burst is inside the tank.
+    // With P = x + cv * v and R = cf * |force| the predicted positions of all
+    // force directions theta form the circle P + R * (cos(theta), sin(theta)).
+    // It is inside the tank (radius L) if:
+    //      |P|^2 + R^2 + 2 R |P| cos(theta - psi) <= L^2,  psi = angle of P
+    // i.e. cos(theta - psi) <= c = (L^2 - |P|^2 - R^2) / (2 R |P|)
+    // -> admissible are all directions with |theta - psi| >= acos(c)
+    // If no direction is admissible the force is reversed (as before).
+    double cv, cf;
+    predictCoefficients(ptrSP->prop, a.steps_till_burst, cv, cf);
     double forceAngle = atan2(a.force[1], a.force[0]);
-    double angularChangeCcw = forceChange2NotCollide(a, ptrSP, M_PI/4);
-    double angularChangeCw = forceChange2NotCollide(a, ptrSP, -M_PI/4);
-    double angle = angularChangeCcw;
-    
-    if(fabs(angularChangeCw) < fabs(angle))
-    {
-        angle = angularChangeCw;
+    double R = cf * sqrt(a.force[0] * a.force[0] + a.force[1] * a.force[1]);
+    double P0 = a.x[0] + cv * a.v[0];
+    double P1 = a.x[1] + cv * a.v[1];
+    double lP = sqrt(P0 * P0 + P1 * P1);
+    double L = ptrSP->sizeL;
+    if (R * lP <= 0){
+        if (lP + R <= L)
+            return forceAngle;
+        return forceAngle + M_PI;
     }
-    
-    return angle + forceAngle;
+    double c = (L * L - lP * lP - R * R) / (2 * R * lP);
+    if (c >= 1)
+        return forceAngle;
+    if (c < -1)
+        return forceAngle + M_PI;
+    double half = acos(c);  // half-width of the forbidden arc around psi
+    double d = forceAngle - atan2(P1, P0);
+    d = fmod(d + 3 * M_PI, 2 * M_PI) - M_PI; // wrap to [-pi, pi)
+    if (fabs(d) >= half)
+        return forceAngle;
+    // rotate to the nearer edge of the forbidden arc
+    if (d >= 0)
+        return forceAngle + (half - d);
+    return forceAngle - (half + d);
 }
 
 
@@ -826,20 +656,18 @@ void FishNetKill(std::vector<particle> &a, std::vector<predator> &preds,
 void PredKill(std::vector<particle> &a, predator &pred,
               params *ptrSP, gsl_rng *r)
 {
+    // only prey close to pred are considered (ptrSP->grid, see Step)
     double dist;
     double r_sense = 4 * ptrSP->kill_range;
     
     if(ptrSP->pred_kill == 1)
     {
-        for(unsigned int i=0; i<a.size(); i++)
+        std::vector<unsigned int> close = GridRadius(ptrSP->grid, a, pred.x,
+                                                     ptrSP->kill_range, ptrSP);
+        for(unsigned int ii=0; ii<close.size(); ii++)
         {
-            dist = CalcDist(pred.x, a[i].x, ptrSP->BC, ptrSP->sizeL);
-            
-            if(dist <= ptrSP->kill_range)
-            {
-                a[i].dead = true;
-                ptrSP->Ndead++;
-            }
+            a[close[ii]].dead = true;
+            ptrSP->Ndead++;
         }
     }
     else if(ptrSP->pred_kill > 1)
@@ -857,20 +685,20 @@ void PredKill(std::vector<particle> &a, predator &pred,
         double prob_catched;
         double total_catch_prob = 0;
         
-        for(unsigned int i=0; i<a.size(); i++)
+        std::vector<unsigned int> sensed = GridRadius(ptrSP->grid, a, pred.x,
+                                                      r_sense, ptrSP);
+        for(unsigned int ii=0; ii<sensed.size(); ii++)
         {
+            unsigned int i = sensed[ii];
             dist = CalcDist(pred.x, a[i].x, ptrSP->BC, ptrSP->sizeL);
             
-            if(dist <= r_sense)
+            N_sensed++;
+            if(dist < ptrSP->kill_range)
             {
-                N_sensed++;
-                if(dist < ptrSP->kill_range)
-                {
-                    possible_kill_id.push_back(i);
-                    prob_catched = (ptrSP->kill_range - dist) / ptrSP->kill_range; // is always > 0 due to if-condition above
-                    catch_probs.push_back( prob_catched );
-                    total_catch_prob += prob_catched;
-                }
+                possible_kill_id.push_back(i);
+                prob_catched = (ptrSP->kill_range - dist) / ptrSP->kill_range; // is always > 0 due to if-condition above
+                catch_probs.push_back( prob_catched );
+                total_catch_prob += prob_catched;
             }
         }
         
@@ -902,7 +730,7 @@ void PredKill(std::vector<particle> &a, predator &pred,
                 prob_killed = effective_kill_rate * ptrSP->dt * prob_selected;
             }
             
-            double luck = gsl_rng_uniform(r); 
+            double luck = RandUniform(ptrSP->rng, RNG_KILL);
             
             if(prob_killed > luck)
             {
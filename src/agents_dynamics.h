@@ -25,6 +25,7 @@
 #include "common_defines.h"
 #include "agents.h"
 #include "agents_operation.h"
+#include "boundary_conditions.h"
 // #include "mathtools.h"
 
 #include <gsl/gsl_rng.h>
@@ -33,12 +34,17 @@
 #include <math.h>
 #include <random>       // std::default_random_engine
 
+// BCP: boundary condition policy (boundary_conditions.h)
+template<class BCP>
 void draw_social_or_environmental_force(particle &a, params *ptrSP,
                                         gsl_rng *r, std::vector<double> &force,
                                         std::vector<double> &hvec, double &force_mag);
 bool overshoot_check(particle &a, std::vector<double> &force, double &force_mag, double &lphi);
+template<class BCP>
 void consider_boundary(particle &a, params *ptrSP);
+template<class BCP>
 void ParticleBurstCoast(particle &a, params * ptrSP, gsl_rng *r);
+unsigned int DrawStepsTillBurst(params *ptrSP, gsl_rng *r);
 template<class agent>
 void Boundary(agent &a, double sizeL,  int BC);             // calculate boundary conditions
 void MovePredator(predator &pred, std::vector<particle> &a, params *ptrSP, gsl_rng *r);
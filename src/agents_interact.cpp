@@ -21,157 +21,357 @@
 */
 
 #include "agents_interact.h"
+#include <omp.h>
 
 
+template<class BCP, class SFM>
+void Interaction(std::vector<particle> &a, params *ptrSP,
+                 std::vector<predator> &preds, bool pred_active)
+{
+    if (ptrSP->kNN > 0){
+        if (!pred_active)
+            InteractionTopologicalF2F<BCP, SFM>(a, ptrSP);
+        else
+            InteractionTopologicalF2FP<BCP, SFM>(a, ptrSP, preds);
+    }
+    else if (ptrSP->engine == 1){
+        if (!pred_active)
+            InteractionGlobal<BCP, SFM>(a, ptrSP);
+        else
+            InteractionPredGlobal<BCP, SFM>(a, ptrSP, preds);
+    }
+    else if (!pred_active)
+        InteractionVoronoiF2F<BCP, SFM>(a, ptrSP);
+    else
+        InteractionVoronoiF2FP<BCP, SFM>(a, ptrSP, preds);
+}
+// instantiation for all boundary conditions and social force models
+#define INSTANTIATE_INTERACTION(BCP) \
+template void Interaction<BCP, SFM4Zone>(std::vector<particle> &, params *, \
+                                         std::vector<predator> &, bool); \
+template void Interaction<BCP, SFMSmooth>(std::vector<particle> &, params *, \
+                                          std::vector<predator> &, bool); \
+template void Interaction<BCP, SFMVoronoiEdge>(std::vector<particle> &, params *, \
+                                               std::vector<predator> &, bool);
+INSTANTIATE_INTERACTION(BCOpen)
+INSTANTIATE_INTERACTION(BCPeriodic)
+INSTANTIATE_INTERACTION(BCInelasticBox)
+INSTANTIATE_INTERACTION(BCElasticBox)
+INSTANTIATE_INTERACTION(BCPeriodicXElasticY)
+INSTANTIATE_INTERACTION(BCPeriodicXInelasticY)
+INSTANTIATE_INTERACTION(BCElasticCircle)
+INSTANTIATE_INTERACTION(BCInelasticCircle)
+INSTANTIATE_INTERACTION(BCArena)
+#undef INSTANTIATE_INTERACTION
+
+
+template<class BCP, class SFM>
 void InteractionVoronoiF2F(std::vector<particle> &a, params *ptrSP)
 {
     // calculates local voronoi interactions
-    typedef CGAL::Exact_predicates_inexact_constructions_kernel         K;
-    typedef CGAL::Triangulation_vertex_base_with_info_2<int, K>         Vb;
-    typedef CGAL::Triangulation_data_structure_2<Vb>                    Tds;
-    typedef CGAL::Delaunay_triangulation_2<K, Tds>                      Delaunay;
-    typedef Delaunay::Vertex_handle                                     Vertex_handle;
-    typedef Delaunay::Edge_iterator                                     Edge_iterator;
-    typedef Delaunay::Point                                             Point;
-    typedef std::pair<Point, int>                                       PPoint;
+    std::vector<predator> none;
+    InteractionVoronoi<BCP, SFM>(a, ptrSP, none, false);
+}
 
-    int N = a.size();
+template<class BCP, class SFM>
+void InteractionVoronoiF2FP(std::vector<particle> &a, params *ptrSP, std::vector<predator> &preds)
+{
+    // voronoi interactions, predators are part of the tessellation
+    InteractionVoronoi<BCP, SFM>(a, ptrSP, preds, true);
+}
 
-    // create the delaunay triangulation network
-    std::vector< std::pair<Point, int> > Vr;   // stores the point location and index
-    std::vector< std::pair< std::vector<double>, int > > posId;
-    Vr.reserve(4 * N);
-    posId.reserve(4 * N);
-    for(int i=0; i<N; i++){
-        Point p1(a[i].x[0], a[i].x[1]);
-        PPoint p2 = std::make_pair(p1, i);
-        Vr.push_back(p2);
-        makePairAndPushBack(posId, a[i].x, i);
+
+template<class BCP, class SFM>
+void InteractionVoronoi(std::vector<particle> &a, params *ptrSP,
+                        std::vector<predator> &preds, bool pred_active)
+{
+    // 1) neighbor list (CSR) of the bursting agents from a single
+    //    (vor_threads=0) or tiled triangulation (voronoi_tiles.h)
+    // 2) owner computes: each agent gathers the forces of its neighbors
+    //    in ascending order -> no writes to other agents (parallel) and
+    //    results independent of the # of threads
+    int N = a.size();
+    step_scratch &W = ptrSP->scratch;
+    std::vector<char> &need = W.need;
+    need.resize(N);
+    bool any = false;
+    for (int i=0; i<N; i++){
+        need[i] = (a[i].bin_step == ptrSP->burst_steps);
+        any = any || need[i];
     }
-    // produce replicate prey for periodic BC
-    if (!ptrSP->BC){
-        std::vector< std::pair< std::vector<double>, int > > newPosId = 
-            GetCopies4PeriodicBC( posId, ptrSP->sizeL );
-        for(int i=0; i<newPosId.size(); i++){
-            Point p1(newPosId[i].first[0], newPosId[i].first[1]);
-            PPoint p2 = std::make_pair(p1, newPosId[i].second);
-            Vr.push_back(p2);
+    if (any){
+        phase_scope ps_nb(ptrSP->timers, PH_NEIGHBORS);
+        std::vector<double> &x = W.x;
+        std::vector<double> &y = W.y;
+        std::vector<int> &id = W.id;
+        x.resize(0);
+        y.resize(0);
+        id.resize(0);
+        for (int i=0; i<N; i++){
+            x.push_back(a[i].x[0]);
+            y.push_back(a[i].x[1]);
+            id.push_back(i);            // prey labeled with index
+        }
+        int predId = -1;
+        for (unsigned int j=0; pred_active && j<preds.size(); j++){
+            x.push_back(preds[j].x[0]);
+            y.push_back(preds[j].x[1]);
+            id.push_back(predId);       // predator: negative
+            predId--;
+        }
+        // replicate prey/predator for periodic BC
+        if (BCP::periodic)
+            AppendCopies4PeriodicBC(x, y, id, ptrSP->sizeL);
+        neighbor_list &NL = W.NL;
+        if (ptrSP->vor_threads > 0)
+            VoronoiNeighborsTiled(x, y, id, N, need, ptrSP->vor_threads, NL,
+                                  &ptrSP->timers, W.vor);
+        else
+            VoronoiNeighbors(x, y, id, N, need, NL, W.vor);
+        ps_nb.stop();
+        phase_scope ps(ptrSP->timers, PH_FORCES);
+        unsigned int threads = std::max(ptrSP->vor_threads, 1u);
+        // voronoi neighbors: at walls (collinear agents) up to all agents
+        ReserveBatches(W.batch, threads, N + preds.size());
+        #pragma omp parallel num_threads(threads)
+        {
+            neighbor_batch &B = W.batch[omp_get_thread_num()];
+            std::vector<int> &nn = B.nn;
+            std::vector<double> &edge = B.edge;
+            trace_scope ts(ptrSP->timers, "gather", omp_get_thread_num());
+            #pragma omp for schedule(static) nowait
+            for (int i=0; i<N; i++){
+                // prey only (prey-predator: PredDetection)
+                nn.resize(0);
+                edge.resize(0);
+                for (unsigned int k=NL.start[i]; k<NL.start[i+1]; k++)
+                    if (NL.nb[k] >= 0){
+                        nn.push_back(NL.nb[k]);
+                        edge.push_back(NL.edge[k]);
+                    }
+                if (nn.size() > 0)
+                    GatherForces<BCP, SFM>(a, i, ptrSP, &nn[0], &edge[0], nn.size(), B);
+            }
         }
     }
-    // do delauney-triangulation
-    Delaunay t;
-    t.insert(Vr.begin(),Vr.end());
-
-    //iterates over all finite edges and apply interaction 
-    //  (infinite edges connect the infinite vertex with the vertices of the complex hull)
-    for(Edge_iterator ei=t.finite_edges_begin(); ei!=t.finite_edges_end(); ei++){
-      // Get a vertex from the edge, edge is stored as pair of the neighboring face and the vertex opposite to it
-      Delaunay::Face& f = *(ei->first);
-      int i = ei->second;
-      Vertex_handle vi = f.vertex(f.cw(i));     // cw = clockwise rotation in face starting at vertex i
-      Vertex_handle vj = f.vertex(f.ccw(i));    // ccw = counter clockwise .....
-      IntCalcPrey(a, vi->info(), vj->info(), ptrSP, false);    // info returns the index
-      IntCalcPrey(a, vj->info(), vi->info(), ptrSP, false);    // 2) symm=false because vij=vj for ASYNC_UPDATE
+    // prey detecting predators (same statistics as IntCalcPred for all pairs)
+    if (pred_active){
+        phase_scope ps(ptrSP->timers, PH_PRED_DETECT);
+        BuildCellGrid(ptrSP->grid, a, ptrSP);
+        for (unsigned int j=0; j<preds.size(); j++)
+            PredDetection<BCP>(a, preds[j], ptrSP);
+    }
+}
 
+
+void AutoEngine(std::vector<particle> &a, params *ptrSP)
+{
+    std::vector<double> &x = ptrSP->scratch.x;
+    std::vector<double> &y = ptrSP->scratch.y;
+    x.resize(0);
+    y.resize(0);
+    for (unsigned int i=0; i<a.size(); i++){
+        x.push_back(a[i].x[0]);
+        y.push_back(a[i].x[1]);
     }
+    unsigned int threads = PickVorThreads(ptrSP->engines, x, y, ptrSP->vor_threads);
+    if (threads != ptrSP->vor_threads)
+        std::cout<< "\nengine auto: vor_threads " << ptrSP->vor_threads << " -> "
+                 << threads << " (N=" << a.size() << ")";
+    ptrSP->vor_threads = threads;
 }
 
-void InteractionVoronoiF2FP(std::vector<particle> &a, params *ptrSP, std::vector<predator> &preds)
+
+void ReserveBatches(std::vector<neighbor_batch> &batch, unsigned int n, unsigned int size)
 {
-    // calculates local voronoi interactions
+    if (batch.size() < n)
+        batch.resize(n);
+    for (unsigned int k=0; k<n; k++){
+        batch[k].nn.reserve(size);
+        batch[k].edge.reserve(size);
+        batch[k].u0.reserve(size);
+        batch[k].u1.reserve(size);
+        batch[k].v0.reserve(size);
+        batch[k].v1.reserve(size);
+        batch[k].dist.reserve(size);
+        batch[k].used.reserve(size);
+    }
+}
+
+
+template<class BCP, class SFM>
+void GatherForces(std::vector<particle> &a, int i, params *ptrSP,
+                  const int *nn, const double *edge, unsigned int n,
+                  neighbor_batch &B)
+{
+    // forces of the n neighbors nn on agent i (only agent i is changed)
+    B.u0.resize(n);
+    B.u1.resize(n);
+    B.v0.resize(n);
+    B.v1.resize(n);
+    B.dist.resize(n);
+    B.used.resize(n);
+    for (unsigned int jj=0; jj<n; jj++){
+        int j = nn[jj];
+        double r_ji[2];
+        CalcDistVecBC<BCP>(a[i].x, a[j].x, ptrSP->sizeL, r_ji);
+        B.dist[jj] = sqrt(r_ji[0] * r_ji[0] + r_ji[1] * r_ji[1]);
+        B.u0[jj] = (B.dist[jj] > 0) ? r_ji[0] / B.dist[jj] : 0;
+        B.u1[jj] = (B.dist[jj] > 0) ? r_ji[1] / B.dist[jj] : 0;
+        B.v0[jj] = a[j].v[0];
+        B.v1[jj] = a[j].v[1];
+    }
+    double f0[2], f1[2], f2[2];
+    unsigned int c[3];
+    SFMBatch<SFM>(ptrSP, n, &B.u0[0], &B.u1[0], &B.v0[0], &B.v1[0],
+                  &B.dist[0], edge, f0, f1, f2, c, &B.used[0]);
+    a[i].force_rep[0] -= f0[0];
+    a[i].force_rep[1] -= f0[1];
+    a[i].force_alg[0] += f1[0];
+    a[i].force_alg[1] += f1[1];
+    a[i].force_att[0] += f2[0];
+    a[i].force_att[1] += f2[1];
+    a[i].counter_rep += c[0];
+    a[i].counter_alg += c[1];
+    a[i].counter_att += c[2];
+    for (unsigned int jj=0; jj<n; jj++)
+        if (B.used[jj] > 0)
+            a[i].NN.push_back(nn[jj]);
+}
+
+
+template<class BCP, class SFM>
+void InteractionTopologicalF2F(std::vector<particle> &a, params *ptrSP)
+{
+    // calculates topological interactions with the kNN nearest neighbors
+    // the kd-tree is only build if at least one agent starts a burst
+    // (only then interactions are computed, see IntCalcPrey)
     typedef CGAL::Exact_predicates_inexact_constructions_kernel         K;
-    typedef CGAL::Triangulation_vertex_base_with_info_2<int, K>         Vb;
-    typedef CGAL::Triangulation_data_structure_2<Vb>                    Tds;
-    typedef CGAL::Delaunay_triangulation_2<K, Tds>                      Delaunay;
-    typedef Delaunay::Vertex_handle                                     Vertex_handle;
-    typedef Delaunay::Edge_iterator                                     Edge_iterator;
-    typedef Delaunay::Point                                             Point;
-    typedef std::pair<Point, int>                                       PPoint;
+    typedef K::Point_2                                                  Point;
+    typedef boost::tuple<Point, int>                                    PointId;
+    typedef CGAL::Search_traits_2<K>                                    Traits_base;
+    typedef CGAL::Search_traits_adapter<PointId,
+            CGAL::Nth_of_tuple_property_map<0, PointId>, Traits_base>   Traits;
+    typedef CGAL::Orthogonal_k_neighbor_search<Traits>                  K_neighbor_search;
+    typedef K_neighbor_search::Tree                                     Tree;
 
     int N = a.size();
-    int predId = -1;
-
-    // create the delaunay triangulation network
-    std::vector< std::pair<Point, int> > Vr;   // stores the point location and index
-    std::vector< std::pair< std::vector<double>, int > > posId;
-    Vr.reserve(4 * ( N + preds.size() ) );
-    posId.reserve(4 * ( N + preds.size() ) );
-    for(int i=0; i<N; i++){
-        Point p1(a[i].x[0], a[i].x[1]);
-        PPoint p2 = std::make_pair(p1, i);  // prey labeled with corresponding index
-        Vr.push_back(p2);
-        makePairAndPushBack(posId, a[i].x, i);
-    }
-    for (int i=0; i<preds.size(); i++){
-        Point p1(preds[i].x[0], preds[i].x[1]);
-        PPoint p2 = std::make_pair(p1, predId);     // predator labeled with negative index
-        Vr.push_back(p2);
-        makePairAndPushBack(posId, preds[i].x, predId);
-        predId--;
+    step_scratch &W = ptrSP->scratch;
+    std::vector<int> &bursting = W.bursting;
+    bursting.resize(0);
+    for (int i=0; i<N; i++)
+        if (a[i].bin_step == ptrSP->burst_steps)
+            bursting.push_back(i);
+    if (bursting.size() == 0 || N < 2)
+        return;
+
+    phase_scope ps_nb(ptrSP->timers, PH_NEIGHBORS);
+    std::vector<double> &x = W.x;
+    std::vector<double> &y = W.y;
+    std::vector<int> &ids = W.id;
+    x.resize(0);
+    y.resize(0);
+    ids.resize(0);
+    for (int i=0; i<N; i++){
+        x.push_back(a[i].x[0]);
+        y.push_back(a[i].x[1]);
+        ids.push_back(i);
     }
-    // produce replicate prey/predator for periodic BC
-    if (!ptrSP->BC){
-        std::vector< std::pair< std::vector<double>, int > > newPosId = 
-            GetCopies4PeriodicBC( posId, ptrSP->sizeL );
-        for(int i=0; i<newPosId.size(); i++){
-            Point p1(newPosId[i].first[0], newPosId[i].first[1]);
-            PPoint p2 = std::make_pair(p1, newPosId[i].second);
-            Vr.push_back(p2);
+    // halo of ghost prey for periodic BC (same index as original)
+    if (BCP::periodic)
+        AppendCopies4PeriodicBC(x, y, ids, ptrSP->sizeL);
+    // the tree copies the points (built from x, y, ids without temporaries)
+    auto point = [&x, &y, &ids](unsigned int k){
+        return PointId(Point(x[k], y[k]), ids[k]);
+    };
+    foreign_alloc_scope fs;
+    Tree tree(boost::make_transform_iterator(boost::counting_iterator<unsigned int>(0), point),
+              boost::make_transform_iterator(boost::counting_iterator<unsigned int>(x.size()), point));
+    fs.end();
+    ps_nb.stop();
+    // kNN queries are part of the force loop
+    phase_scope ps(ptrSP->timers, PH_FORCES);
+    unsigned int k = std::min(ptrSP->kNN, static_cast<unsigned int>(N - 1));
+    ReserveBatches(W.batch, 1, k);
+    neighbor_batch &B = W.batch[0];
+    std::vector<int> &nn = B.nn;
+    // no voronoi edges -> inf
+    std::vector<double> &edge = B.edge;
+    edge.assign(k, std::numeric_limits<double>::infinity());
+    for (unsigned int ii=0; ii<bursting.size(); ii++){
+        int i = bursting[ii];
+        Point query(a[i].x[0], a[i].x[1]);
+        // query contains i itself and (periodic BC) possibly ghosts of
+        // the same agent -> enlarge query until k distinct neighbors found
+        unsigned int n_query = k + 1;
+        while (true){
+            nn.resize(0);
+            foreign_alloc_scope fs_q;   // kd-tree (built at 1st query), queue
+            K_neighbor_search search(tree, query, n_query);
+            fs_q.end();
+            for (K_neighbor_search::iterator it=search.begin(); it!=search.end(); it++){
+                int j = boost::get<1>(it->first);
+                if (j != i && std::find(nn.begin(), nn.end(), j) == nn.end())
+                    nn.push_back(j);
+                if (nn.size() == k)
+                    break;
+            }
+            if (nn.size() == k || n_query >= x.size())
+                break;
+            n_query = std::min(2 * n_query, static_cast<unsigned int>(x.size()));
         }
+        if (nn.size() > 0)
+            GatherForces<BCP, SFM>(a, i, ptrSP, &nn[0], &edge[0], nn.size(), B);
     }
+}
 
-    Delaunay t;
-    t.insert(Vr.begin(),Vr.end());
-
-    //iterates over all finite edges and apply interaction 
-    //  (infinite edges connect the infinite vertex with the vertices of the complex hull)
-    for(Edge_iterator ei=t.finite_edges_begin(); ei!=t.finite_edges_end(); ei++){
-        // Get a vertex from the edge, edge is stored as pair of the neighboring face and the vertex opposite to it
-        Delaunay::Face& f = *(ei->first);
-        int i = ei->second;
-        Vertex_handle vi = f.vertex(f.cw(i));             // cw = clockwise rotation in face starting at vertex i
-        Vertex_handle vj = f.vertex(f.ccw(i));            // ccw = counter clockwise .....
-        if ((vi->info() >= 0) && (vj->info() >= 0)){      // both F
-          IntCalcPrey(a, vi->info(), vj->info(), ptrSP, true);
-        }
-    }
-    for (int i=0; i<a.size(); i++)
-        for (int j=0; j<preds.size(); j++)
-            IntCalcPred(a, i, preds[j], ptrSP);
+template<class BCP, class SFM>
+void InteractionTopologicalF2FP(std::vector<particle> &a, params *ptrSP, std::vector<predator> &preds)
+{
+    // topological fish-fish interactions and fish-pred as in InteractionVoronoiF2FP
+    InteractionTopologicalF2F<BCP, SFM>(a, ptrSP);
+    phase_scope ps(ptrSP->timers, PH_PRED_DETECT);
+    for (unsigned int i=0; i<a.size(); i++)
+        for (unsigned int j=0; j<preds.size(); j++)
+            IntCalcPred<BCP>(a, i, preds[j], ptrSP);
 }
 
 
+template<class BCP, class SFM>
 void InteractionGlobal(std::vector<particle> &a, params *ptrSP)
 {
     // Simple brute force algorithm for global interactions
     // checking all the N*(N-1)/2 combinations
     int i,j;
     int N = a.size();
+    phase_scope ps(ptrSP->timers, PH_FORCES);
 
     for(i=0;i<N;i++){
         for(j=i+1;j<N;j++){
-            IntCalcPrey(a, i, j, ptrSP, false);
-            IntCalcPrey(a, j, i, ptrSP, false);    // info returns the index
+            IntCalcPrey<BCP, SFM>(a, i, j, ptrSP, false);
+            IntCalcPrey<BCP, SFM>(a, j, i, ptrSP, false);    // info returns the index
         }
     }
 }
 
+template<class BCP, class SFM>
 void InteractionPredGlobal(std::vector<particle> &a, params *ptrSP, std::vector<predator> &preds)
 {
-    // Simple brute force algorithm for global interactions /w predator only
-    // checking all the N combinations
-    int N = a.size();
-    int i, j;
-
-    for(i=0;i<N;i++){
-        for(j=0;j<N;j++)
-            IntCalcPred(a, i, preds[j], ptrSP);
-    }
+    // global fish-fish interactions and fish-pred as in InteractionTopologicalF2FP
+    // (was fish-pred only, with j running over N instead of the predators)
+    InteractionGlobal<BCP, SFM>(a, ptrSP);
+    phase_scope ps(ptrSP->timers, PH_PRED_DETECT);
+    for (unsigned int i=0; i<a.size(); i++)
+        for (unsigned int j=0; j<preds.size(); j++)
+            IntCalcPred<BCP>(a, i, preds[j], ptrSP);
 }
 
-void IntCalcPrey(std::vector<particle> &a, int i, int j, params *ptrSP, bool symm)
+template<class BCP, class SFM>
+void IntCalcPrey(std::vector<particle> &a, int i, int j, params *ptrSP, bool symm,
+                 double edge)
 {
     // Function updating social forces for a pair of interacting agents
+    // edge: length of shared voronoi edge (only used by SFMVoronoiEdge)
     // Please Note that for local metric interaction the cutoff distance
     // is set to 1.2 x interaction range
     // only compute interaction if necessary (at start of burst)
@@ -179,23 +379,23 @@ void IntCalcPrey(std::vector<particle> &a, int i, int j, params *ptrSP, bool sym
         return;
     symm = false; // ASYNC_UPDATE
     // check if interaction already computed (only relevant for periodic BC)
-    if (!ptrSP->BC){    // BC=0: periodic BC
+    if (BCP::periodic){    // BC=0: periodic BC
         int there;
         there = where_val_in_vector<unsigned int>(a[i].NN,
                                                   static_cast<unsigned int>(j));
         if (there != a[i].NN.size())   // if interaction already computed
             return;
     }
-    std::vector<double> r_ji(2);
+    double r_ji[2];
     double u_ji[2];
     double dist_interaction;
     unsigned int c[3] = {0, 0, 0};
     double f0[2], f1[2], f2[2];
-    f0[0] = f1[0] =  f2[0] = f0[1] = f1[1] =  f2[1] = 0;
+    double w[3];
     u_ji[0] = u_ji[1] = 0.0;
     // Calc relative distance vector and corresponding unit vector
-    r_ji = CalcDistVec(a[i].x, a[j].x, ptrSP->BC, ptrSP->sizeL);  // vec i->j
-    dist_interaction = vec_length(r_ji);
+    CalcDistVecBC<BCP>(a[i].x, a[j].x, ptrSP->sizeL, r_ji);  // vec i->j
+    dist_interaction = sqrt(r_ji[0] * r_ji[0] + r_ji[1] * r_ji[1]);
     if(dist_interaction > 0.0)
     {
         u_ji[0]=r_ji[0]/dist_interaction;
@@ -206,8 +406,15 @@ void IntCalcPrey(std::vector<particle> &a, int i, int j, params *ptrSP, bool sym
     // v_ji[1] = a[j].v[1] - a[i].v[1];
     v_ji[0] = a[j].v[0];
     v_ji[1] = a[j].v[1];
-    SFM_4Zone(ptrSP, u_ji, dist_interaction, v_ji,
-              c, f0, f1, f2);
+    SFM::Weights(ptrSP, dist_interaction, edge, w);
+    for (unsigned int k=0; k<3; k++)
+        c[k] = (w[k] > 0);
+    f0[0] = w[0] * u_ji[0];
+    f0[1] = w[0] * u_ji[1];
+    f1[0] = w[1] * v_ji[0];
+    f1[1] = w[1] * v_ji[1];
+    f2[0] = w[2] * u_ji[0];
+    f2[1] = w[2] * u_ji[1];
     if (c[0]){
         a[i].force_rep[0] -= f0[0];
         a[i].force_rep[1] -= f0[1];
@@ -248,28 +455,121 @@ void IntCalcPrey(std::vector<particle> &a, int i, int j, params *ptrSP, bool sym
                 a[j].NN.push_back(i);
     }
 }
+// instantiation for the benchmark (bench/swarmbench.cpp)
+template void IntCalcPrey<BCPeriodic, SFM4Zone>(std::vector<particle> &, int, int,
+                                                params *, bool, double);
+template void IntCalcPrey<BCInelasticCircle, SFM4Zone>(std::vector<particle> &, int, int,
+                                                       params *, bool, double);
+
+template<class BCP>
+void PredDetection(std::vector<particle> &a, predator &pred, params *ptrSP)
+{
+    // Samples which prey detect pred with the probability of IntCalcPred
+    //      p(d) = 2 / ( 1 + d / flee_range )   (>= 1 for d <= flee_range)
+    // without drawing a random number for every prey:
+    // - prey in cells closer than flee_range: IntCalcPred
+    // - far cells are grouped in shells  flee_range * 2^k <= d_cell < flee_range * 2^(k+1)
+    //   with bounding prob. q_k = p(flee_range * 2^k). Candidates are drawn
+    //   with prob. q_k by geometric skipping and accepted with p(d) / q_k (thinning)
+    // requires ptrSP->grid with current prey positions
+    // the shells are a CSR list of cells in ptrSP->scratch (ascending cells)
+    cellgrid &grid = ptrSP->grid;
+    double fr = ptrSP->flee_range;
+    step_scratch &W = ptrSP->scratch;
+    int ncells = grid.head.size();
+    W.shell_of.resize(ncells);
+    W.shell_start.assign(62, 0);
+    int nshells = 0;
+    for (int c=0; c<ncells; c++){
+        W.shell_of[c] = -1;
+        if (grid.count[c] == 0)
+            continue;
+        double d_cell = GridCellDist<BCP>(grid, c, pred.x, ptrSP->sizeL);
+        if (d_cell <= fr){
+            for (int i=grid.head[c]; i!=-1; i=grid.next[i])
+                IntCalcPred<BCP>(a, i, pred, ptrSP);
+            continue;
+        }
+        int k = std::min(static_cast<int>(log2(d_cell / fr)), 60);
+        W.shell_of[c] = k;
+        W.shell_start[k + 1]++;
+        nshells = std::max(nshells, k + 1);
+    }
+    for (int k=0; k<nshells; k++)
+        W.shell_start[k + 1] += W.shell_start[k];
+    W.shell_cells.resize(W.shell_start[nshells]);
+    for (int c=0; c<ncells; c++)    // counting sort: cells stay ascending
+        if (W.shell_of[c] >= 0)
+            W.shell_cells[W.shell_start[W.shell_of[c]]++] = c;
+    for (int k=nshells; k>0; k--)   // restore the starts
+        W.shell_start[k] = W.shell_start[k - 1];
+    W.shell_start[0] = 0;
+    for (int k=0; k<nshells; k++){
+        if (W.shell_start[k + 1] == W.shell_start[k])
+            continue;
+        double q = 2 / ( 1 + pow(2, k) );
+        // # of candidates skipped before next proposal
+        unsigned int skip = RandFailures(ptrSP->rng, q, RNG_DETECT);
+        for (unsigned int cc=W.shell_start[k]; cc<W.shell_start[k + 1]; cc++){
+            int c = W.shell_cells[cc];
+            if (skip >= static_cast<unsigned int>(grid.count[c])){
+                skip -= grid.count[c];
+                continue;
+            }
+            for (int i=grid.head[c]; i!=-1; i=grid.next[i]){
+                if (skip > 0){
+                    skip--;
+                    continue;
+                }
+                double dist = CalcDistBC<BCP>(a[i].x, pred.x, ptrSP->sizeL);
+                double fstrength = 2 / ( 1 + dist / fr );
+                if (RandUniform(ptrSP->rng, RNG_DETECT) * q < fstrength)
+                    PredDetected<BCP>(a, i, pred, ptrSP);
+                skip = RandFailures(ptrSP->rng, q, RNG_DETECT);
+            }
+        }
+    }
+}
+
+template<class BCP>
+void PredDetected(std::vector<particle> &a, int i, predator &pred, params *ptrSP)
+{
+    // prey i detected pred -> flees from it
+    if (BCP::periodic && pred.NNset.count(static_cast<unsigned int>(i)))
+        return;     // interaction already computed
+    double r_ip[2];
+    CalcDistVecBC<BCP>(a[i].x, pred.x, ptrSP->sizeL, r_ip);
+    double dist = sqrt(r_ip[0] * r_ip[0] + r_ip[1] * r_ip[1]);
+    a[i].counter_flee++;
+    pred.NNset.insert(i);
+    if (dist > 0){
+        a[i].force_flee[0] -= r_ip[0] / dist;
+        a[i].force_flee[1] -= r_ip[1] / dist;
+    }
+}
 
+template<class BCP>
 void IntCalcPred(std::vector<particle> &a, int i, predator &pred, params *ptrSP)
 {
     // Function updating social forces for predator and a single prey
     //////////////////
     // check if interaction already computed (only relevant for periodic BC)
-    if (!ptrSP->BC){    // BC=0: periodic BC
+    if (BCP::periodic){    // BC=0: periodic BC
         bool contains;
         contains = pred.NNset.count(static_cast<unsigned int>(i));
         if (contains) // interaction already computed
             return;
     }
-    std::vector<double> r_ip(2);
+    double r_ip[2];
     double u_ip[2];
     double ang;
     double dist_interaction;
     u_ip[0]=u_ip[1]=0.0;
 
     // Calc relative distance vector and corresponding unit vector
-    r_ip = CalcDistVec(a[i].x, pred.x, ptrSP->BC, ptrSP->sizeL);
+    CalcDistVecBC<BCP>(a[i].x, pred.x, ptrSP->sizeL, r_ip);
     ang = atan2(r_ip[1], r_ip[0]);
-    dist_interaction = vec_length(r_ip);
+    dist_interaction = sqrt(r_ip[0] * r_ip[0] + r_ip[1] * r_ip[1]);
     if(dist_interaction>0.0)
     {
         u_ip[0] = cos(ang);
@@ -280,7 +580,7 @@ void IntCalcPred(std::vector<particle> &a, int i, predator &pred, params *ptrSP)
     // here fstrength represents the probability to react to predator as environmental cue
     // after flee_range the probability is below 1 to detect the predator:
     fstrength = 2 / ( 1 + dist_interaction / ptrSP->flee_range );
-    double random = gsl_rng_uniform(ptrSP->r);
+    double random = RandUniform(ptrSP->rng, RNG_DETECT);
     // if(fstrength > 0.0){
     if(random < fstrength){
         a[i].counter_flee++;
@@ -26,9 +26,13 @@
 #include "agents_operation.h"
 #include "mathtools.h"
 #include "social_forces.h"
+#include "boundary_conditions.h"
 #include "settings.h"
+#include "voronoi_tiles.h"
+#include "alloc_counter.h"
 
 #include <algorithm>
+#include <limits>
 #include <vector>
 
 // for nearest neighbor search needed
@@ -47,20 +51,60 @@
 #include <CGAL/Search_traits_adapter.h>         // for nearest neighbor search to change points class 
 #include <CGAL/Orthogonal_k_neighbor_search.h>  // for nearest neighbor search needed
 #include <CGAL/property_map.h>                  // for nearest neighbor search needed
-#include <boost/iterator/zip_iterator.hpp>      // for nearest neighbor search needed
+#include <boost/iterator/counting_iterator.hpp>  // for nearest neighbor search needed
+#include <boost/iterator/transform_iterator.hpp> // for nearest neighbor search needed
 
+// all interactions of a step (voronoi or topological, with or w/o predator)
+// BCP: boundary condition policy (boundary_conditions.h)
+// SFM: social force model policy (social_forces.h)
+template<class BCP, class SFM>
+void Interaction(std::vector<particle> &, params *,
+                 std::vector<predator> &, bool pred_active);
+// voronoi: fish-fish
+template<class BCP, class SFM>
 void InteractionVoronoiF2F(std::vector<particle> &a, params *);
 // voronoi: fish-fish, fish-pred
+template<class BCP, class SFM>
 void InteractionVoronoiF2FP(std::vector<particle> &, params *,
         std::vector<predator> &);
+// voronoi neighbor list (single or tiled triangulation, vor_threads),
+// then each agent gathers its forces: fish-fish (, fish-pred)
+template<class BCP, class SFM>
+void InteractionVoronoi(std::vector<particle> &, params *,
+        std::vector<predator> &, bool pred_active);
+// topological (kNN nearest neighbors): fish-fish
+template<class BCP, class SFM>
+void InteractionTopologicalF2F(std::vector<particle> &, params *);
+// topological: fish-fish, fish-pred
+template<class BCP, class SFM>
+void InteractionTopologicalF2FP(std::vector<particle> &, params *,
+        std::vector<predator> &);
 // global: fish-fish
+template<class BCP, class SFM>
 void InteractionGlobal(std::vector<particle> &, params *);
 // global: fish-fish, fish-pred
+template<class BCP, class SFM>
 void InteractionPredGlobal(std::vector<particle> &, params *,
         std::vector<predator> &);
+// engine=-1: vor_threads of the cheapest voronoi engine (engine_select.h)
+void AutoEngine(std::vector<particle> &, params *);
+// (at least) n batches with capacity for size neighbors
+void ReserveBatches(std::vector<neighbor_batch> &batch, unsigned int n, unsigned int size);
+// fish-fish: forces of the n neighbors nn on agent i
+template<class BCP, class SFM>
+void GatherForces(std::vector<particle> &, int i, params *,
+                  const int *nn, const double *edge, unsigned int n,
+                  neighbor_batch &);
 // fish-fish:
-void IntCalcPrey(std::vector<particle> &, int, int, params *, bool symm);
+template<class BCP, class SFM>
+void IntCalcPrey(std::vector<particle> &, int, int, params *, bool symm,
+                 double edge=std::numeric_limits<double>::infinity());
 // fish-pred:
+template<class BCP>
 void IntCalcPred(std::vector<particle> &, int, predator &, params *);
+template<class BCP>
+void PredDetection(std::vector<particle> &, predator &, params *);
+template<class BCP>
+void PredDetected(std::vector<particle> &, int, predator &, params *);
 
 #endif
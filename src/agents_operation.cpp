@@ -205,30 +205,294 @@ template
 std::vector<unsigned int> GetPredFrontPrey(std::vector<particle> &a, params *ptrSP, predator *pred, std::vector<int> &nodes);
 
 
+// cell coordinate along one dimension (not wrapped, limited to avoid int-overflow)
+static int GridCoord(double x, double x0, double cs, int n)
+{
+    double c = floor((x - x0) / cs);
+    c = fmax(c, -n - 1);
+    c = fmin(c, 2 * n);
+    return static_cast<int>(c);
+}
+
+// maps cell coordinate into grid (periodic: wrap, else: clamp)
+static int GridWrap(int c, int n, bool periodic)
+{
+    if (periodic)
+        return ((c % n) + n) % n;
+    return std::min(std::max(c, 0), n - 1);
+}
+
+template <class T>
+void BuildCellGrid(cellgrid &grid, std::vector<T> &a, params *ptrSP)
+{
+    // linked-cell list with about 1 agent per cell
+    // BC=0: grid covers periodic box [0, L)^2
+    // else: grid covers bounding box of agents
+    int N = a.size();
+    int n = std::max(1, static_cast<int>(ceil(sqrt(N))));
+    grid.periodic = (ptrSP->BC == 0);
+    if (grid.periodic){
+        grid.x0 = grid.y0 = 0;
+        grid.nx = grid.ny = n;
+        grid.cs = ptrSP->sizeL / n;
+    }
+    else{
+        double xmin, xmax, ymin, ymax;
+        xmin = ymin = std::numeric_limits<double>::max();
+        xmax = ymax = std::numeric_limits<double>::lowest();
+        for (int i=0; i<N; i++){
+            xmin = fmin(xmin, a[i].x[0]);
+            xmax = fmax(xmax, a[i].x[0]);
+            ymin = fmin(ymin, a[i].x[1]);
+            ymax = fmax(ymax, a[i].x[1]);
+        }
+        if (N == 0)
+            xmin = xmax = ymin = ymax = 0;
+        double w = fmax(xmax - xmin, ymax - ymin);
+        grid.cs = (w > 0) ? w / n : 1;
+        grid.x0 = xmin;
+        grid.y0 = ymin;
+        grid.nx = std::min(n, GridCoord(xmax, xmin, grid.cs, n) + 1);
+        grid.ny = std::min(n, GridCoord(ymax, ymin, grid.cs, n) + 1);
+    }
+    grid.head.assign(grid.nx * grid.ny, -1);
+    grid.count.assign(grid.nx * grid.ny, 0);
+    grid.next.assign(N, -1);
+    for (int i=0; i<N; i++){
+        int cx = GridWrap(GridCoord(a[i].x[0], grid.x0, grid.cs, grid.nx), grid.nx, grid.periodic);
+        int cy = GridWrap(GridCoord(a[i].x[1], grid.y0, grid.cs, grid.ny), grid.ny, grid.periodic);
+        int c = cx + cy * grid.nx;
+        grid.next[i] = grid.head[c];
+        grid.head[c] = i;
+        grid.count[c]++;
+    }
+}
+template
+void BuildCellGrid(cellgrid &grid, std::vector<particle> &a, params *ptrSP);
+template
+void BuildCellGrid(cellgrid &grid, std::vector<predator> &a, params *ptrSP);
+
+
+
+
+template <class T>
+int GridNearest(cellgrid &grid, std::vector<T> &a, std::vector<double> &x,
+                params *ptrSP, double &mindist)
+{
+    // returns index of agent closest to x (-1 if no agent) and its distance
+    // searches rings of cells around x until no closer agent is possible
+    int best = -1;
+    mindist = std::numeric_limits<double>::max();
+    if (a.size() == 0)
+        return best;
+    int cx = GridWrap(GridCoord(x[0], grid.x0, grid.cs, grid.nx), grid.nx, grid.periodic);
+    int cy = GridWrap(GridCoord(x[1], grid.y0, grid.cs, grid.ny), grid.ny, grid.periodic);
+    int kmax = std::max(grid.nx, grid.ny);
+    for (int k=0; k<=kmax; k++){
+        for (int dy=-k; dy<=k; dy++){
+            int iy = cy + dy;
+            if (!grid.periodic && (iy < 0 || iy >= grid.ny))
+                continue;
+            iy = GridWrap(iy, grid.ny, grid.periodic);
+            int step = (abs(dy) == k) ? 1 : 2 * k;  // only cells on ring k
+            for (int dx=-k; dx<=k; dx+=step){
+                int ix = cx + dx;
+                if (!grid.periodic && (ix < 0 || ix >= grid.nx))
+                    continue;
+                ix = GridWrap(ix, grid.nx, grid.periodic);
+                for (int j=grid.head[ix + iy * grid.nx]; j!=-1; j=grid.next[j]){
+                    double dist = CalcDist(x, a[j].x, ptrSP->BC, ptrSP->sizeL);
+                    // same result as linear scan: smallest index wins ties
+                    if (dist < mindist || (dist == mindist && j < best)){
+                        mindist = dist;
+                        best = j;
+                    }
+                }
+            }
+        }
+        // agents outside ring k are at least k * cs away
+        if (best >= 0 && mindist <= k * grid.cs)
+            break;
+    }
+    return best;
+}
+template
+int GridNearest(cellgrid &grid, std::vector<particle> &a, std::vector<double> &x,
+                params *ptrSP, double &mindist);
+template
+int GridNearest(cellgrid &grid, std::vector<predator> &a, std::vector<double> &x,
+                params *ptrSP, double &mindist);
+
+
+template <class T>
+std::vector<unsigned int> GridRadius(cellgrid &grid, std::vector<T> &a,
+                                     std::vector<double> &x, double radius, params *ptrSP)
+{
+    // returns sorted indices of agents with distance to x <= radius
+    std::vector<unsigned int> ids;
+    if (a.size() == 0)
+        return ids;
+    int xlo = GridCoord(x[0] - radius, grid.x0, grid.cs, grid.nx);
+    int xhi = GridCoord(x[0] + radius, grid.x0, grid.cs, grid.nx);
+    int ylo = GridCoord(x[1] - radius, grid.y0, grid.cs, grid.ny);
+    int yhi = GridCoord(x[1] + radius, grid.y0, grid.cs, grid.ny);
+    if (grid.periodic){
+        // each cell only once
+        if (xhi - xlo + 1 >= grid.nx){
+            xlo = 0;
+            xhi = grid.nx - 1;
+        }
+        if (yhi - ylo + 1 >= grid.ny){
+            ylo = 0;
+            yhi = grid.ny - 1;
+        }
+    }
+    else{
+        xlo = std::max(xlo, 0);
+        ylo = std::max(ylo, 0);
+        xhi = std::min(xhi, grid.nx - 1);
+        yhi = std::min(yhi, grid.ny - 1);
+    }
+    for (int iy=ylo; iy<=yhi; iy++){
+        int cy = GridWrap(iy, grid.ny, grid.periodic);
+        for (int ix=xlo; ix<=xhi; ix++){
+            int cx = GridWrap(ix, grid.nx, grid.periodic);
+            for (int j=grid.head[cx + cy * grid.nx]; j!=-1; j=grid.next[j])
+                if (CalcDist(x, a[j].x, ptrSP->BC, ptrSP->sizeL) <= radius)
+                    ids.push_back(j);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+template
+std::vector<unsigned int> GridRadius(cellgrid &grid, std::vector<particle> &a,
+                                     std::vector<double> &x, double radius, params *ptrSP);
+template
+std::vector<unsigned int> GridRadius(cellgrid &grid, std::vector<predator> &a,
+                                     std::vector<double> &x, double radius, params *ptrSP);
+
+
 
 void split_dead(std::vector<particle> &a, std::vector<particle> &d,
                 std::vector<predator> &preds){
-    for (int i=0; i<a.size(); i++){
-        if (a[i].dead){
-            d.push_back(a[i]);
-            a.erase(a.begin() + i);
-            i--;
-        }
+    // stable compaction in 1 pass (amortized O(N), no copies):
+    // alive agents are moved forward, dead agents are moved to d.
+    // The order (ascending id or the spatial order of SpatialSort) is kept.
+    unsigned int n = a.size();
+    unsigned int i = 0;
+    while (i < n && !a[i].dead)
+        i++;
+    if (i == n)     // nobody died (most steps)
+        return;
+    unsigned int alive = i;
+    for (; i<n; i++){
+        if (a[i].dead)
+            d.push_back(std::move(a[i]));
+        else
+            a[alive++] = std::move(a[i]);
     }
+    a.erase(a.begin() + alive, a.end());
 }
 
 void merge_dead(std::vector<particle> &a,
                                  std::vector<particle> &d){
     std::vector<particle> all(a.size() + d.size());
     for (int i=0; i<a.size(); i++)
-        all[a[i].id] = a[i];
+        all[a[i].id] = std::move(a[i]);
     for (int i=0; i<d.size(); i++)
-        all[d[i].id] = d[i];
+        all[d[i].id] = std::move(d[i]);
     d.resize(0);
-    a = all;
+    a.swap(all);
+}
+
+
+// position of cell (x, y) of a 2^16 x 2^16 grid along the Hilbert curve
+static uint64_t HilbertKey(uint32_t x, uint32_t y)
+{
+    const uint32_t n = 1u << 16;
+    uint64_t d = 0;
+    for (uint32_t s=n/2; s>0; s/=2){
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        // rotate quadrant
+        if (ry == 0){
+            if (rx == 1){
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+
+void SpatialSort(std::vector<particle> &a, params *ptrSP)
+{
+    // re-orders the agents in memory along a Hilbert curve: agents close in
+    // space are close in memory, which keeps the neighbor loops (interaction,
+    // cell lists, kill checks) cache friendly for large N.
+    // The ids are unchanged (output maps id -> slot, see IdToSlot).
+    // Domain: periodic box [0, L)^2 for BC=0, else bounding box of agents.
+    unsigned int N = a.size();
+    if (N < 3)
+        return;
+    double x0, y0, w;
+    if (ptrSP->BC == 0){
+        x0 = y0 = 0;
+        w = ptrSP->sizeL;
+    }
+    else{
+        double xmax, ymax;
+        x0 = y0 = std::numeric_limits<double>::max();
+        xmax = ymax = std::numeric_limits<double>::lowest();
+        for (unsigned int i=0; i<N; i++){
+            x0 = fmin(x0, a[i].x[0]);
+            xmax = fmax(xmax, a[i].x[0]);
+            y0 = fmin(y0, a[i].x[1]);
+            ymax = fmax(ymax, a[i].x[1]);
+        }
+        w = fmax(xmax - x0, ymax - y0);
+    }
+    double scale = (w > 0) ? 65535 / w : 0;
+    std::vector< std::pair<uint64_t, unsigned int> > key(N);
+    for (unsigned int i=0; i<N; i++){
+        double cx = fmin(fmax(floor((a[i].x[0] - x0) * scale), 0), 65535);
+        double cy = fmin(fmax(floor((a[i].x[1] - y0) * scale), 0), 65535);
+        key[i].first = HilbertKey(static_cast<uint32_t>(cx),
+                                  static_cast<uint32_t>(cy));
+        key[i].second = i;
+    }
+    // equal keys are ordered by slot -> deterministic
+    std::sort(key.begin(), key.end());
+    std::vector<particle> sorted;
+    sorted.reserve(N);
+    for (unsigned int i=0; i<N; i++)
+        sorted.push_back(std::move(a[key[i].second]));
+    a.swap(sorted);
 }
 
 
+template <class T>
+std::vector<int> IdToSlot(std::vector<T> &a)
+{
+    // id -> slot in a (-1 if not in a, e.g. dead), size: largest id + 1
+    unsigned int n = 0;
+    for (unsigned int i=0; i<a.size(); i++)
+        n = std::max(n, a[i].id + 1);
+    std::vector<int> slot(n, -1);
+    for (unsigned int i=0; i<a.size(); i++)
+        slot[a[i].id] = i;
+    return slot;
+}
+template
+std::vector<int> IdToSlot(std::vector<particle> &a);
+template
+std::vector<int> IdToSlot(std::vector<predator> &a);
+
+
 void makePairAndPushBack(std::vector< std::pair< std::vector<double>, int > > &vecpair,
                          std::vector<double> &vec, int id){
     std::pair< std::vector<double>, int > newPair;
@@ -252,10 +516,8 @@ std::vector< std::pair< std::vector<double>, int > > GetCopies4PeriodicBC(
     for (int i = 0; i < posId.size(); i++){
         pos = posId[i].first;
         id = posId[i].second;
-        if (pos[0] < L/2)
-            left = true;
-        if (pos[1] < L/2)
-            lower = true;
+        left = (pos[0] < L/2);
+        lower = (pos[1] < L/2);
         if (left && lower){
             newPos = vec_add(pos, up);
             makePairAndPushBack(newPosId, newPos, id);
@@ -291,3 +553,26 @@ std::vector< std::pair< std::vector<double>, int > > GetCopies4PeriodicBC(
     }
     return newPosId;
 }
+
+
+void AppendCopies4PeriodicBC(std::vector<double> &x, std::vector<double> &y,
+                             std::vector<int> &id, double L)
+{
+    unsigned int n = x.size();
+    for (unsigned int i=0; i<n; i++){
+        double px = x[i];
+        double py = y[i];
+        int pid = id[i];
+        // shift towards the center: up/right if in the lower/left half
+        double sx = (px < L/2) ? px + L : px - L;
+        double sy = (py < L/2) ? py + L : py - L;
+        x.push_back(px);
+        y.push_back(sy);
+        x.push_back(sx);
+        y.push_back(sy);
+        x.push_back(sx);
+        y.push_back(py);
+        for (unsigned int k=0; k<3; k++)
+            id.push_back(pid);
+    }
+}
@@ -55,11 +55,47 @@ double AreaConvexHull(std::vector<particle> &a, std::vector<int> &nodes); // com
 double get_elongation(std::vector<particle> &a, std::vector<double> &dir, std::vector<int> &nodes);
 void split_dead(std::vector<particle> &a, std::vector<particle> &d, std::vector<predator> &preds);
 void merge_dead(std::vector<particle> &a, std::vector<particle> &d);
+// memory order of agents along a space-filling curve (ids are kept)
+void SpatialSort(std::vector<particle> &a, params *ptrSP);
+template <class T>
+std::vector<int> IdToSlot(std::vector<T> &a);
 // returns indicese of Prey(in "nodes") in front of Pred
 template <class O, class I>
 std::vector<O> GetPredFrontPrey(std::vector<particle> &a, params *ptrSP, predator *pred, std::vector<I> &nodes);
+// spatial index of agents: build once per step, then query
+template <class T>
+void BuildCellGrid(cellgrid &grid, std::vector<T> &a, params *ptrSP);
+template <class T>
+int GridNearest(cellgrid &grid, std::vector<T> &a, std::vector<double> &x,
+                params *ptrSP, double &mindist);
+template <class T>
+std::vector<unsigned int> GridRadius(cellgrid &grid, std::vector<T> &a,
+                                     std::vector<double> &x, double radius, params *ptrSP);
+// smallest distance between x and any point of cell c (minimum image if
+// BCP::periodic, no temporaries: hot path of PredDetection)
+template <class BCP>
+inline double GridCellDist(const cellgrid &grid, int c, const std::vector<double> &x,
+                           double sizeL)
+{
+    int ix = c % grid.nx;
+    int iy = c / grid.nx;
+    double r[2] = {grid.x0 + (ix + 0.5) * grid.cs - x[0],
+                   grid.y0 + (iy + 0.5) * grid.cs - x[1]};
+    if (BCP::periodic)
+        for (int d=0; d<2; d++){
+            double sign = sgn(r[d]);
+            r[d] = fmod(r[d] + sign * sizeL/2, sizeL) - sign * sizeL/2;
+        }
+    double dx = fmax(fabs(r[0]) - grid.cs / 2, 0);
+    double dy = fmax(fabs(r[1]) - grid.cs / 2, 0);
+    return sqrt(dx * dx + dy * dy);
+}
 void makePairAndPushBack(std::vector< std::pair< std::vector<double>, int > > &vecpair,
                          std::vector<double> &vec, int id);
 std::vector< std::pair< std::vector<double>, int > > GetCopies4PeriodicBC(
         std::vector< std::pair< std::vector<double>, int > > &posId, double L);
+// the same for points as arrays: the copies (same id, same order as
+// GetCopies4PeriodicBC) are appended to x, y, id (no temporaries)
+void AppendCopies4PeriodicBC(std::vector<double> &x, std::vector<double> &y,
+                             std::vector<int> &id, double L);
 #endif
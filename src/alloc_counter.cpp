@@ -0,0 +1,155 @@
+/*  AllocCounter
+    counts heap allocations (replaced global operator new)
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<bool> counting(false);
+static std::atomic<unsigned long long> n_allocs(0);
+static std::atomic<unsigned long long> n_bytes(0);
+static std::atomic<unsigned long long> n_foreign(0);
+static thread_local int foreign_depth = 0;
+
+
+void AllocCounting(bool on)
+{
+    counting.store(on, std::memory_order_relaxed);
+}
+
+
+bool AllocCountingOn()
+{
+    return counting.load(std::memory_order_relaxed);
+}
+
+
+alloc_stats AllocStats()
+{
+    alloc_stats S;
+    S.allocs = n_allocs.load(std::memory_order_relaxed);
+    S.bytes = n_bytes.load(std::memory_order_relaxed);
+    S.foreign = n_foreign.load(std::memory_order_relaxed);
+    return S;
+}
+
+
+foreign_alloc_scope::foreign_alloc_scope() : open(true)
+{
+    foreign_depth++;
+}
+
+
+foreign_alloc_scope::~foreign_alloc_scope()
+{
+    end();
+}
+
+
+void foreign_alloc_scope::end()
+{
+    if (open)
+        foreign_depth--;
+    open = false;
+}
+
+
+static void *CountedAlloc(std::size_t size)
+{
+    if (counting.load(std::memory_order_relaxed)){
+        if (foreign_depth > 0)
+            n_foreign.fetch_add(1, std::memory_order_relaxed);
+        else{
+            n_allocs.fetch_add(1, std::memory_order_relaxed);
+            n_bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+    return malloc(size > 0 ? size : 1);
+}
+
+
+// replacements of the global allocation functions
+void *operator new(std::size_t size)
+{
+    void *p = CountedAlloc(size);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+
+void *operator new[](std::size_t size)
+{
+    void *p = CountedAlloc(size);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return CountedAlloc(size);
+}
+
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return CountedAlloc(size);
+}
+
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    free(p);
+}
+
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    free(p);
+}
+
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
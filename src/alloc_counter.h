@@ -0,0 +1,50 @@
+/*  AllocCounter
+    counts heap allocations (replaced global operator new)
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef alloc_counter_H
+#define alloc_counter_H
+
+// Every operator new (std::vector, std::string, std::set, ...) of the
+// program is counted while counting is switched on (params.timing or
+// params.alloc_check), off it costs 1 branch per allocation.
+// Allocations inside a foreign_alloc_scope (CGAL triangulation and kd-tree
+// internals, not under our control) are counted separately.
+struct alloc_stats{
+    unsigned long long allocs;      // own allocations
+    unsigned long long bytes;       // requested by own allocations
+    unsigned long long foreign;     // inside foreign_alloc_scope
+};
+typedef struct alloc_stats alloc_stats;
+
+void AllocCounting(bool on);
+bool AllocCountingOn();
+// totals since the start (thread safe, relaxed)
+alloc_stats AllocStats();
+
+// allocations of the current thread within its scope are foreign
+struct foreign_alloc_scope{
+    bool open;
+    foreign_alloc_scope();
+    ~foreign_alloc_scope();
+    // ends the scope before the end of the block
+    void end();
+};
+#endif
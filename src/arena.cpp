@@ -0,0 +1,391 @@
+/*  Arena
+    arbitrary tank geometries (polygon or image mask) precomputed into a
+    signed distance field (SDF) for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "arena.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+
+static const uint64_t SDF_VERSION = 1;  // increase if the SDF-computation changes
+
+
+static uint64_t HashBytes(const char *data, size_t n, uint64_t hash)
+{
+    // FNV-1a 64 bit
+    for (size_t i=0; i<n; i++){
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+static void ArenaGradient(arena &A)
+{
+    // central differences (one-sided at the grid border)
+    A.gx.assign(A.nx * A.ny, 0);
+    A.gy.assign(A.nx * A.ny, 0);
+    for (int j=0; j<A.ny; j++)
+        for (int i=0; i<A.nx; i++){
+            int il = (i > 0) ? i - 1 : i;
+            int ir = (i < A.nx - 1) ? i + 1 : i;
+            int jl = (j > 0) ? j - 1 : j;
+            int jr = (j < A.ny - 1) ? j + 1 : j;
+            int k = j * A.nx + i;
+            A.gx[k] = (A.d[j * A.nx + ir] - A.d[j * A.nx + il]) / ((ir - il) * A.h);
+            A.gy[k] = (A.d[jr * A.nx + i] - A.d[jl * A.nx + i]) / ((jr - jl) * A.h);
+        }
+}
+
+
+bool ArenaFromPolygon(arena &A, std::string fname, double h)
+{
+    std::ifstream in(fname.c_str());
+    if (!in)
+        return false;
+    // read rings
+    std::vector< std::vector<double> > rings(1);
+    std::string line;
+    while (std::getline(in, line)){
+        std::istringstream ls(line);
+        double x, y;
+        if (ls >> x >> y){
+            rings.back().push_back(x);
+            rings.back().push_back(y);
+        }
+        else if (rings.back().size() > 0)
+            rings.push_back(std::vector<double>(0));
+    }
+    // edges (closed rings)
+    std::vector<double> e;  // x1 y1 x2 y2
+    double xmin = std::numeric_limits<double>::max();
+    double ymin = xmin;
+    double xmax = -xmin;
+    double ymax = -xmin;
+    for (unsigned int r=0; r<rings.size(); r++){
+        unsigned int nv = rings[r].size() / 2;
+        if (nv < 3)
+            continue;
+        for (unsigned int v=0; v<nv; v++){
+            unsigned int w = (v + 1) % nv;
+            e.push_back(rings[r][2*v]);
+            e.push_back(rings[r][2*v+1]);
+            e.push_back(rings[r][2*w]);
+            e.push_back(rings[r][2*w+1]);
+            xmin = fmin(xmin, rings[r][2*v]);
+            xmax = fmax(xmax, rings[r][2*v]);
+            ymin = fmin(ymin, rings[r][2*v+1]);
+            ymax = fmax(ymax, rings[r][2*v+1]);
+        }
+    }
+    if (e.size() == 0)
+        return false;
+    double margin = 4 * h;
+    A.h = h;
+    A.x0 = xmin - margin;
+    A.y0 = ymin - margin;
+    A.nx = static_cast<int>(ceil((xmax - xmin + 2 * margin) / h)) + 1;
+    A.ny = static_cast<int>(ceil((ymax - ymin + 2 * margin) / h)) + 1;
+    A.d.assign(A.nx * A.ny, 0);
+    unsigned int ne = e.size() / 4;
+    for (int j=0; j<A.ny; j++)
+        for (int i=0; i<A.nx; i++){
+            double px = A.x0 + i * h;
+            double py = A.y0 + j * h;
+            double d2 = std::numeric_limits<double>::max();
+            bool inside = false;
+            for (unsigned int k=0; k<ne; k++){
+                double ax = e[4*k], ay = e[4*k+1];
+                double bx = e[4*k+2], by = e[4*k+3];
+                // distance to segment
+                double ex = bx - ax, ey = by - ay;
+                double l2 = ex * ex + ey * ey;
+                double t = (l2 > 0) ? ((px - ax) * ex + (py - ay) * ey) / l2 : 0;
+                t = fmin(fmax(t, 0.), 1.);
+                double dx = px - ax - t * ex;
+                double dy = py - ay - t * ey;
+                d2 = fmin(d2, dx * dx + dy * dy);
+                // even-odd rule (ray in +x direction)
+                if ((ay > py) != (by > py) &&
+                    px < ax + (py - ay) * ex / ey)
+                    inside = !inside;
+            }
+            A.d[j * A.nx + i] = inside ? sqrt(d2) : -sqrt(d2);
+        }
+    ArenaGradient(A);
+    return true;
+}
+
+
+static void EDT1D(std::vector<double> &f, int n, std::vector<double> &out,
+                  std::vector<int> &v, std::vector<double> &z)
+{
+    // squared euclidean distance transform along 1 dimension
+    // (lower envelope of parabolas, Felzenszwalb & Huttenlocher 2012)
+    double inf = std::numeric_limits<double>::max();
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = inf;
+    for (int q=1; q<n; q++){
+        double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k]){
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k+1] = inf;
+    }
+    k = 0;
+    for (int q=0; q<n; q++){
+        while (z[k+1] < q)
+            k++;
+        out[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+
+static void EDT2D(std::vector<double> &grid, int nx, int ny)
+{
+    // grid: 0 at the sources, large elsewhere -> squared distance to sources
+    int n = std::max(nx, ny);
+    std::vector<double> f(n), out(n), z(n + 1);
+    std::vector<int> v(n);
+    for (int i=0; i<nx; i++){
+        for (int j=0; j<ny; j++)
+            f[j] = grid[j * nx + i];
+        EDT1D(f, ny, out, v, z);
+        for (int j=0; j<ny; j++)
+            grid[j * nx + i] = out[j];
+    }
+    for (int j=0; j<ny; j++){
+        for (int i=0; i<nx; i++)
+            f[i] = grid[j * nx + i];
+        EDT1D(f, nx, out, v, z);
+        for (int i=0; i<nx; i++)
+            grid[j * nx + i] = out[i];
+    }
+}
+
+
+bool ArenaFromMask(arena &A, std::string fname, double h)
+{
+    std::ifstream in(fname.c_str(), std::ios::binary);
+    if (!in)
+        return false;
+    std::string magic;
+    in >> magic;
+    if (magic != "P2" && magic != "P5")
+        return false;
+    int header[3];  // width, height, maxval
+    for (int i=0; i<3; i++){
+        in >> std::ws;
+        while (in.peek() == '#'){   // skip comments
+            std::string comment;
+            std::getline(in, comment);
+            in >> std::ws;
+        }
+        in >> header[i];
+    }
+    int w = header[0];
+    int hgt = header[1];
+    int maxval = header[2];
+    if (!in || w <= 0 || hgt <= 0 || maxval <= 0 || maxval > 255)
+        return false;
+    in.get();   // single whitespace before binary data
+    // 1 wall-pixel border around the image
+    A.h = h;
+    A.nx = w + 2;
+    A.ny = hgt + 2;
+    A.x0 = -h;
+    A.y0 = -h;
+    std::vector<bool> free(A.nx * A.ny, false);
+    for (int row=0; row<hgt; row++)
+        for (int col=0; col<w; col++){
+            int value;
+            if (magic == "P5")
+                value = static_cast<unsigned char>(in.get());
+            else
+                in >> value;
+            // image rows go downwards, y upwards
+            free[(hgt - row) * A.nx + col + 1] = (value > maxval / 2);
+        }
+    if (!in)
+        return false;
+    double big = 1e20;
+    std::vector<double> to_wall(A.nx * A.ny), to_free(A.nx * A.ny);
+    for (int k=0; k<A.nx*A.ny; k++){
+        to_wall[k] = free[k] ? big : 0;
+        to_free[k] = free[k] ? 0 : big;
+    }
+    EDT2D(to_wall, A.nx, A.ny);
+    EDT2D(to_free, A.nx, A.ny);
+    // wall is half a pixel between free and wall pixel centers
+    A.d.assign(A.nx * A.ny, 0);
+    for (int k=0; k<A.nx*A.ny; k++)
+        A.d[k] = free[k] ? (sqrt(to_wall[k]) - 0.5) * h : -(sqrt(to_free[k]) - 0.5) * h;
+    ArenaGradient(A);
+    return true;
+}
+
+
+static bool ReadArenaCache(arena &A, std::string fname)
+{
+    FILE *fp = fopen(fname.c_str(), "rb");
+    if (fp == NULL)
+        return false;
+    int n[2];
+    double geo[3];
+    bool ok = (fread(n, sizeof(int), 2, fp) == 2) &&
+              (fread(geo, sizeof(double), 3, fp) == 3) &&
+              n[0] > 0 && n[1] > 0;
+    if (ok){
+        A.nx = n[0];
+        A.ny = n[1];
+        A.h = geo[0];
+        A.x0 = geo[1];
+        A.y0 = geo[2];
+        size_t nn = A.nx * A.ny;
+        A.d.resize(nn);
+        A.gx.resize(nn);
+        A.gy.resize(nn);
+        ok = (fread(&A.d[0], sizeof(double), nn, fp) == nn) &&
+             (fread(&A.gx[0], sizeof(double), nn, fp) == nn) &&
+             (fread(&A.gy[0], sizeof(double), nn, fp) == nn);
+    }
+    fclose(fp);
+    return ok;
+}
+
+
+static void WriteArenaCache(arena &A, std::string fname)
+{
+    // write a temporary file and replace the cache at once (interrupted or
+    // concurrent runs never leave a truncated cache)
+    std::string tmp = fname + ".tmp." + std::to_string(getpid());
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (fp == NULL)
+        return;
+    int n[2] = {A.nx, A.ny};
+    double geo[3] = {A.h, A.x0, A.y0};
+    size_t nn = A.nx * A.ny;
+    bool ok = (fwrite(n, sizeof(int), 2, fp) == 2 &&
+               fwrite(geo, sizeof(double), 3, fp) == 3 &&
+               fwrite(&A.d[0], sizeof(double), nn, fp) == nn &&
+               fwrite(&A.gx[0], sizeof(double), nn, fp) == nn &&
+               fwrite(&A.gy[0], sizeof(double), nn, fp) == nn);
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), fname.c_str()) != 0)
+        remove(tmp.c_str());
+}
+
+
+bool LoadArena(arena &A, params *ptrSP)
+{
+    // loads the SDF from the cache or computes and caches it
+    std::string fname = ptrSP->location + ptrSP->arena_file;
+    std::ifstream in(fname.c_str(), std::ios::binary);
+    if (!in){
+        std::cout<< "arena file " << fname << " not found" << std::endl;
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+    uint64_t hash = 14695981039346656037ULL;
+    hash = HashBytes(content.data(), content.size(), hash);
+    hash = HashBytes(reinterpret_cast<const char*>(&ptrSP->arena_res), sizeof(double), hash);
+    hash = HashBytes(reinterpret_cast<const char*>(&SDF_VERSION), sizeof(uint64_t), hash);
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    std::string cache = fname + "_" + hex + ".sdf";
+    if (ReadArenaCache(A, cache))
+        return true;
+    bool mask = (fname.size() > 4 && fname.substr(fname.size() - 4) == ".pgm");
+    bool ok;
+    if (mask)
+        ok = ArenaFromMask(A, fname, ptrSP->arena_res);
+    else
+        ok = ArenaFromPolygon(A, fname, ptrSP->arena_res);
+    if (!ok){
+        std::cout<< "arena file " << fname << " could not be read" << std::endl;
+        return false;
+    }
+    WriteArenaCache(A, cache);
+    return true;
+}
+
+
+double ArenaForceDirection(const arena &A, double P[2], double R, double angle)
+{
+    // force direction closest to "angle" for which the predicted position
+    // P + R * (cos, sin) is in free space: "angle" itself if admissible
+    // (as closestForceDirection), else scans alternating ccw and cw in
+    // steps of pi/32 (64 O(1) SDF lookups at most),
+    // the rotation is done by complex multiplication (no trigonometric calls)
+    // If no direction is admissible the force is reversed.
+    const int steps = 32;
+    double dphi = M_PI / steps;
+    double c = cos(dphi);
+    double s = sin(dphi);
+    double g[2];
+    double ccw[2] = {cos(angle), sin(angle)};
+    double cw[2] = {ccw[0], ccw[1]};
+    if (ArenaDist(A, P[0] + R * ccw[0], P[1] + R * ccw[1], g) > 0)
+        return angle;
+    for (int k=1; k<steps; k++){
+        double h = ccw[0];
+        ccw[0] = c * h - s * ccw[1];
+        ccw[1] = s * h + c * ccw[1];
+        if (ArenaDist(A, P[0] + R * ccw[0], P[1] + R * ccw[1], g) > 0)
+            return angle + k * dphi;
+        h = cw[0];
+        cw[0] = c * h + s * cw[1];
+        cw[1] = -s * h + c * cw[1];
+        if (ArenaDist(A, P[0] + R * cw[0], P[1] + R * cw[1], g) > 0)
+            return angle - k * dphi;
+    }
+    return angle + M_PI;
+}
+
+
+void ArenaPlaceInside(const arena &A, std::vector<particle> &a, double margin, gsl_rng *r)
+{
+    // agents which are not in free space (at least margin from the wall)
+    // are placed uniformly at random in free space
+    double g[2];
+    double Lx = (A.nx - 1) * A.h;
+    double Ly = (A.ny - 1) * A.h;
+    for (unsigned int i=0; i<a.size(); i++){
+        unsigned int tries = 0;
+        while (ArenaDist(A, a[i].x[0], a[i].x[1], g) < margin && tries < 100000){
+            a[i].x[0] = A.x0 + Lx * gsl_rng_uniform(r);
+            a[i].x[1] = A.y0 + Ly * gsl_rng_uniform(r);
+            tries++;
+        }
+    }
+}
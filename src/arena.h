@@ -0,0 +1,83 @@
+/*  Arena
+    arbitrary tank geometries (polygon or image mask) precomputed into a
+    signed distance field (SDF) for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef arena_H
+#define arena_H
+#include "agents.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <gsl/gsl_rng.h>
+
+// Geometry files (path relative to params.location):
+//  *.pgm   image mask (P2 or P5), pixel > maxval/2 is free space,
+//          pixel size = params.arena_res, lower left pixel at (0, 0)
+//  else    polygon: one vertex "x y" per line, rings separated by empty lines,
+//          free space = inside an odd number of rings (outer wall + obstacles)
+// The SDF is sampled on nodes with spacing arena_res and cached next to the
+// geometry file as <file>_<hash>.sdf (hash of file content and resolution).
+struct arena{
+    int nx, ny;                 // # of nodes in x and y
+    double h;                   // node spacing
+    double x0, y0;              // position of node (0, 0)
+    std::vector<double> d;      // signed distance to the wall (>0: free space)
+    std::vector<double> gx, gy; // gradient of d (points into free space)
+};
+typedef struct arena arena;
+
+bool LoadArena(arena &A, params *ptrSP);
+bool ArenaFromPolygon(arena &A, std::string fname, double h);
+bool ArenaFromMask(arena &A, std::string fname, double h);
+double ArenaForceDirection(const arena &A, double P[2], double R, double angle);
+void ArenaPlaceInside(const arena &A, std::vector<particle> &a, double margin, gsl_rng *r);
+
+// bilinear interpolation of the SDF and its gradient g (O(1) lookup),
+// outside of the grid the distance to the grid is subtracted
+inline double ArenaDist(const arena &A, double x, double y, double g[2])
+{
+    double fx = (x - A.x0) / A.h;
+    double fy = (y - A.y0) / A.h;
+    double cx = fmin(fmax(fx, 0.), A.nx - 1.000001);
+    double cy = fmin(fmax(fy, 0.), A.ny - 1.000001);
+    int i = static_cast<int>(cx);
+    int j = static_cast<int>(cy);
+    double tx = cx - i;
+    double ty = cy - j;
+    int k = j * A.nx + i;
+    double w00 = (1 - tx) * (1 - ty);
+    double w10 = tx * (1 - ty);
+    double w01 = (1 - tx) * ty;
+    double w11 = tx * ty;
+    double d = w00 * A.d[k] + w10 * A.d[k + 1] + w01 * A.d[k + A.nx] + w11 * A.d[k + A.nx + 1];
+    g[0] = w00 * A.gx[k] + w10 * A.gx[k + 1] + w01 * A.gx[k + A.nx] + w11 * A.gx[k + A.nx + 1];
+    g[1] = w00 * A.gy[k] + w10 * A.gy[k + 1] + w01 * A.gy[k + A.nx] + w11 * A.gy[k + A.nx + 1];
+    double ox = (cx - fx) * A.h;
+    double oy = (cy - fy) * A.h;
+    double out = sqrt(ox * ox + oy * oy);
+    if (out > 0){
+        g[0] = ox / out;
+        g[1] = oy / out;
+        d -= out;
+    }
+    return d;
+}
+#endif
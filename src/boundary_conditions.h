@@ -0,0 +1,331 @@
+/*  BoundaryConditions
+    compile-time policies for the boundary conditions (BC) of
+    SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef boundary_conditions_H
+#define boundary_conditions_H
+#include "mathtools.h"
+#include "arena.h"
+
+#include <cmath>
+#include <vector>
+
+// Every policy defines:
+//      id          value of params.BC
+//      periodic    distances via minimum image, periodic copies for voronoi
+//      circle      circular tank (wall avoidance at burst start)
+//      sdf         arena given by a signed distance field (wall avoidance at burst start)
+//      Apply(a, L) moves agent "a" back into the domain
+// The step loop is instantiated once per policy (see SelectStep in swarmdyn.cpp)
+// so that these checks are resolved at compile time.
+
+struct BCOpen{
+    static const int id = -1;
+    static const bool periodic = false;
+    static const bool circle = false;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL){}
+};
+
+struct BCPeriodic{
+    static const int id = 0;
+    static const bool periodic = true;
+    static const bool circle = false;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        a.x[0] = fmod(a.x[0] + sizeL, sizeL);
+        a.x[1] = fmod(a.x[1] + sizeL, sizeL);
+    }
+};
+
+struct BCInelasticBox{
+    static const int id = 1;
+    static const bool periodic = false;
+    static const bool circle = false;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        // TODO: any case which changes the velocity should also change u, phi
+        double dphi=0.1;
+        double tmpphi;
+        if(a.x[0]>sizeL)
+        {
+            a.x[0]=0.9999*sizeL;
+            if(a.v[1]>0.)
+                tmpphi=(0.5+dphi)*M_PI;
+            else
+                tmpphi=-(0.5+dphi)*M_PI;
+
+            a.v[0]=cos(tmpphi);
+            a.v[1]=sin(tmpphi);
+        }
+        else if(a.x[0]<0)
+        {
+            a.x[0]=0.0001;
+
+            if(a.v[1]>0.)
+            {
+                tmpphi=(0.5-dphi)*M_PI;
+            }
+            else
+            {
+                tmpphi=-(0.5-dphi)*M_PI;
+            }
+
+            a.v[0]=cos(tmpphi);
+            a.v[1]=sin(tmpphi);
+        }
+        if(a.x[1]>sizeL)
+        {
+            a.x[1]=0.9999*sizeL;
+            if(a.v[0]>0.)
+                tmpphi=-dphi;
+            else
+                tmpphi=M_PI+dphi;
+
+            a.v[0]=cos(tmpphi);
+            a.v[1]=sin(tmpphi);
+
+        }
+        else if(a.x[1]<0)
+        {
+            a.x[1]=0.0001;
+            if(a.v[0]>0.)
+                tmpphi=dphi;
+            else
+                tmpphi=M_PI-dphi;
+
+            a.v[0]=cos(tmpphi);
+            a.v[1]=sin(tmpphi);
+        }
+    }
+};
+
+struct BCElasticBox{
+    static const int id = 2;
+    static const bool periodic = false;
+    static const bool circle = false;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        double dx;
+        if(a.x[0]>sizeL)
+        {
+            dx=2.*(a.x[0]-sizeL);
+            a.x[0]-=dx;
+            a.v[0]*=-1.;
+        }
+        else if(a.x[0]<0)
+        {
+            dx=2.*a.x[0];
+            a.x[0]-=dx;
+            a.v[0]*=-1.;
+        }
+        if(a.x[1]>sizeL)
+        {
+            dx=2.*(a.x[1]-sizeL);
+            a.x[1]-=dx;
+            a.v[1]*=-1.;
+        }
+        else if(a.x[1]<0)
+        {
+            dx=2.*a.x[1];
+            a.x[1]-=dx;
+            a.v[1]*=-1.;
+        }
+    }
+};
+
+// x-periodic BCs: distances are NOT computed with minimum image
+// (as before, only BC=0 is treated as periodic in CalcDistVec)
+struct BCPeriodicXElasticY{
+    static const int id = 3;
+    static const bool periodic = false;
+    static const bool circle = false;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        double dx;
+        double tx= fmod(a.x[0], sizeL);
+        if(tx < 0.0f)
+            tx += sizeL;
+        a.x[0]=tx;
+
+        if(a.x[1]>sizeL)
+        {
+            dx=2.*(a.x[1]-sizeL);
+            a.x[1]-=dx;
+            a.v[1]*=-1.;
+        }
+        else if(a.x[1]<0)
+        {
+            dx=2.*a.x[1];
+            a.x[1]-=dx;
+            a.v[1]*=-1.;
+        }
+    }
+};
+
+struct BCPeriodicXInelasticY{
+    static const int id = 4;
+    static const bool periodic = false;
+    static const bool circle = false;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        double dx;
+        double tx= fmod(a.x[0], sizeL);
+        if(tx < 0.0f)
+        {
+            tx += sizeL;
+        }
+        a.x[0]=tx;
+
+        if(a.x[1]>sizeL)
+        {
+            dx=(a.x[1]-sizeL);
+            a.x[1]-=dx+0.0001;
+            a.v[1]=0.0;
+        }
+        else if(a.x[1]<0)
+        {
+            dx=a.x[1];
+            a.x[1]-=dx-0.0001;
+            a.v[1]=0.0;
+        }
+    }
+};
+
+// circle of radius sizeL centered at the origin
+// elastic: mirror velocity, inelastic: remove velocity normal to the wall
+template<bool elastic>
+inline void CircleBoundary(std::vector<double> &x, std::vector<double> &v,
+                           std::vector<double> &u, double &phi, double sizeL)
+{
+    double dist2cen = vec_length(x);
+    double diff = dist2cen - sizeL;
+    if (diff > 0)
+    {
+        double inv = 1 / dist2cen;
+        double wall_normal[2] = {x[0] * inv, x[1] * inv};   // a.x / |a.x|
+        // 1. mirror the position at the circular wall
+        double f = - 2 * diff;
+        x[0] += wall_normal[0] * f;
+        x[1] += wall_normal[1] * f;
+        // 2. mirror the velocity / set velocity component normal to wall to 0
+        diff = wall_normal[0] * v[0] + wall_normal[1] * v[1];
+        f = (elastic) ? - 2 * diff : -diff;
+        v[0] += wall_normal[0] * f;
+        v[1] += wall_normal[1] * f;
+        // 3. update rest of agent properties
+        u = v;
+        vec_set_mag221(u, 1);
+        phi = atan2(u[1], u[0]);
+    }
+}
+
+struct BCElasticCircle{
+    static const int id = 5;
+    static const bool periodic = false;
+    static const bool circle = true;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        CircleBoundary<true>(a.x, a.v, a.u, a.phi, sizeL);
+    }
+};
+
+struct BCInelasticCircle{
+    static const int id = 6;
+    static const bool periodic = false;
+    static const bool circle = true;
+    static const bool sdf = false;
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        CircleBoundary<false>(a.x, a.v, a.u, a.phi, sizeL);
+    }
+};
+
+// arbitrary arena (see arena.h), elastic reflection at the wall:
+// agents outside of the free space are mirrored at the zero level set of the SDF
+struct BCArena{
+    static const int id = 7;
+    static const bool periodic = false;
+    static const bool circle = false;
+    static const bool sdf = true;
+    static const arena *field;  // set in main (LoadArena)
+    template<class agent>
+    static inline void Apply(agent &a, double sizeL)
+    {
+        double g[2];
+        double d = ArenaDist(*field, a.x[0], a.x[1], g);
+        if (d < 0)
+        {
+            double lg = sqrt(g[0] * g[0] + g[1] * g[1]);
+            if (lg == 0)
+                return;
+            double n0 = g[0] / lg;
+            double n1 = g[1] / lg;
+            a.x[0] -= 2 * d * n0;
+            a.x[1] -= 2 * d * n1;
+            double vn = n0 * a.v[0] + n1 * a.v[1];
+            if (vn < 0){
+                a.v[0] -= 2 * vn * n0;
+                a.v[1] -= 2 * vn * n1;
+            }
+            a.u = a.v;
+            vec_set_mag221(a.u, 1);
+            a.phi = atan2(a.u[1], a.u[0]);
+        }
+    }
+};
+
+// distance vector ri -> rj (minimum image if periodic)
+template<class BCP>
+inline void CalcDistVecBC(std::vector<double> &ri, std::vector<double> &rj,
+                          double sizeL, double r_ji[2])
+{
+    r_ji[0] = rj[0] - ri[0];
+    r_ji[1] = rj[1] - ri[1];
+    if (BCP::periodic)
+        for(unsigned int d=0; d<2; d++){
+            double sign = sgn(r_ji[d]);
+            r_ji[d] = fmod(r_ji[d] + sign * sizeL/2, sizeL) - sign * sizeL/2;
+        }
+}
+
+template<class BCP>
+inline double CalcDistBC(std::vector<double> &ri, std::vector<double> &rj, double sizeL)
+{
+    double r_ji[2];
+    CalcDistVecBC<BCP>(ri, rj, sizeL, r_ji);
+    return sqrt(r_ji[0] * r_ji[0] + r_ji[1] * r_ji[1]);
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*  BurstIntervals
+    O(1) samplers of the # of steps between bursts
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "burst_intervals.h"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+
+bool InitBurstSampler(burst_sampler &B, int dist, double burst_rate,
+                      double dt, double shape, std::string fname)
+{
+    double p = burst_rate * dt;
+    B.dist = dist;
+    B.dt = dt;
+    B.p = p;
+    B.kmax = (p > 0) ? static_cast<unsigned int>(5 / p) + 1 : 1;
+    B.inv_log1mp = (p > 0 && p < 1) ? 1 / log1p(-p) : 0;
+    B.table = NULL;
+    B.values.resize(0);
+    if (dist == 1){
+        // mean = shape * scale = 1 / burst_rate
+        B.shape = shape;
+        B.scale = 1 / (burst_rate * shape);
+    }
+    else if (dist == 2){
+        // mean = exp(mu + sigma^2 / 2) = 1 / burst_rate
+        B.shape = shape;
+        B.scale = -log(burst_rate) - shape * shape / 2;
+    }
+    else if (dist == 3){
+        std::ifstream in(fname.c_str());
+        std::vector<double> weights;
+        std::string line;
+        while (std::getline(in, line)){
+            std::istringstream ls(line);
+            double t, w = 1;
+            if (!(ls >> t))
+                continue;
+            ls >> w;
+            if (t > 0 && w > 0){
+                B.values.push_back(t);
+                weights.push_back(w);
+            }
+        }
+        if (B.values.size() == 0){
+            std::cout<< "no burst intervals in " << fname << ": geometric used" << std::endl;
+            B.dist = 0;
+            return false;
+        }
+        B.table = gsl_ran_discrete_preproc(weights.size(), &weights[0]);
+        // recorded intervals are never truncated
+        for (unsigned int i=0; i<B.values.size(); i++)
+            B.kmax = std::max(B.kmax, static_cast<unsigned int>(ceil(B.values[i] / dt)));
+    }
+    else if (dist != 0){
+        std::cout<< "unknown burst_dist=" << dist << ": geometric used" << std::endl;
+        B.dist = 0;
+        return false;
+    }
+    if ((dist == 1 || dist == 2) && !(shape > 0)){
+        std::cout<< "burst_shape has to be > 0: geometric used" << std::endl;
+        B.dist = 0;
+        return false;
+    }
+    return true;
+}
+
+
+unsigned int DrawBurstInterval(const burst_sampler &B, gsl_rng *r)
+{
+    // returns the # of steps till the next burst (1 <= steps <= kmax)
+    double steps;
+    switch (B.dist)
+    {
+        case 1:
+            steps = ceil(gsl_ran_gamma(r, B.shape, B.scale) / B.dt);
+            break;
+        case 2:
+            steps = ceil(gsl_ran_lognormal(r, B.scale, B.shape) / B.dt);
+            break;
+        case 3:
+            steps = ceil(B.values[gsl_ran_discrete(r, B.table)] / B.dt - 1e-9);
+            break;
+        default:
+            // inversion of the geometric distribution
+            // P(steps = k) = (1 - p)^(k-1) * p
+            return GeometricInterval(B, gsl_rng_uniform(r));
+    }
+    if (!(steps < B.kmax))  // also catches inf
+        return B.kmax;
+    if (steps < 1)
+        return 1;
+    return static_cast<unsigned int>(steps);
+}
+
+
+void FreeBurstSampler(burst_sampler &B)
+{
+    if (B.table != NULL)
+        gsl_ran_discrete_free(B.table);
+    B.table = NULL;
+}
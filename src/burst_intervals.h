@@ -0,0 +1,67 @@
+/*  BurstIntervals
+    O(1) samplers of the # of steps between bursts
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef burst_intervals_H
+#define burst_intervals_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+// distributions of the inter-burst interval (params.burst_dist):
+//  0   geometric: at each step a burst starts with prob. burst_rate * dt
+//  1   gamma with mean 1/burst_rate and shape burst_shape
+//  2   lognormal with mean 1/burst_rate and sigma burst_shape
+//  3   empirical: intervals in seconds from file, one per line "t [weight]"
+// All are truncated at kmax = 5 / (burst_rate * dt) + 1 steps (as the
+// original Bernoulli-per-step loop, empirical: at least the longest interval)
+// and need O(1) random numbers per burst
+// (the loop needed on average 1 / (burst_rate * dt)).
+struct burst_sampler{
+    int dist;
+    unsigned int kmax;          // maximal # of steps (truncation)
+    double dt;
+    double p;                   // geometric: burst probability per step
+    double inv_log1mp;          // geometric: 1 / log(1 - burst_rate * dt)
+    double shape, scale;        // gamma: shape, scale, lognormal: sigma, mu
+    std::vector<double> values; // empirical: intervals
+    gsl_ran_discrete_t *table;  // empirical: alias table of the weights
+};
+typedef struct burst_sampler burst_sampler;
+
+bool InitBurstSampler(burst_sampler &B, int dist, double burst_rate,
+                      double dt, double shape, std::string fname);
+unsigned int DrawBurstInterval(const burst_sampler &B, gsl_rng *r);
+void FreeBurstSampler(burst_sampler &B);   // frees the alias table (empirical)
+
+// geometric intervals (dist=0) by inversion of the uniform u in [0, 1)
+inline unsigned int GeometricInterval(const burst_sampler &B, double u)
+{
+    if (B.p >= 1)
+        return 1;
+    if (B.p <= 0)
+        return B.kmax;
+    double steps = floor(log1p(-u) * B.inv_log1mp) + 1;
+    return (steps < B.kmax) ? static_cast<unsigned int>(steps) : B.kmax;
+}
+#endif
@@ -1,6 +1,6 @@
 // macro switches to set programme behavior at compile time
 #ifndef COMMON_DEFINES_H
 #define COMMON_DEFINES_H
-#define OUTPUT_SIMTIME_PER_OUTSTEP 0 // enables continous output of step and time per step
 #define PRINT_PARAMS 0               // prints out parameters before the run
+#define PRINT_RNG_USAGE 0            // prints the # of random numbers per subsystem after the run
 #endif
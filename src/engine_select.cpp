@@ -0,0 +1,330 @@
+/*  EngineSelect
+    calibrated cost model of the voronoi neighbor search (engine=-1: auto)
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "engine_select.h"
+#include "voronoi_tiles.h"
+
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <omp.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define CALIB_NMIN 256
+#define CALIB_NMAX 262144
+#define CALIB_TMAX 0.2      // no larger N once a candidate needs longer [s]
+#define OCC_MAXCELLS 4096   // cells per side of Occupancy
+
+
+static std::string CacheFile()
+{
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    std::string dir;
+    if (getenv("SWARMDYN_CACHE") != NULL)
+        dir = getenv("SWARMDYN_CACHE");
+    else if (getenv("HOME") != NULL){
+        dir = std::string(getenv("HOME")) + "/.cache";
+        mkdir(dir.c_str(), 0755);
+        dir += "/swarmdyn";
+    }
+    else
+        dir = ".";
+    mkdir(dir.c_str(), 0755);
+    return dir + "/engine_model_" + host + ".dat";
+}
+
+
+// synthetic configuration, layout 0: uniform (density 1), 1: 8 clusters
+static void SyntheticPoints(unsigned int n, int layout, std::mt19937 &gen,
+                            std::vector<double> &x, std::vector<double> &y)
+{
+    double L = sqrt(static_cast<double>(n));
+    std::uniform_real_distribution<double> uni(0, 1);
+    x.resize(n);
+    y.resize(n);
+    if (layout == 0){
+        for (unsigned int i=0; i<n; i++){
+            x[i] = L * uni(gen);
+            y[i] = L * uni(gen);
+        }
+        return;
+    }
+    int nc = 8;
+    std::normal_distribution<double> gauss(0, sqrt(n / static_cast<double>(nc)) / 2);
+    std::vector<double> cx(nc), cy(nc);
+    for (int c=0; c<nc; c++){
+        cx[c] = 4 * L * uni(gen);
+        cy[c] = 4 * L * uni(gen);
+    }
+    for (unsigned int i=0; i<n; i++){
+        x[i] = cx[i % nc] + gauss(gen);
+        y[i] = cy[i % nc] + gauss(gen);
+    }
+}
+
+
+// seconds of one neighbor search of all points (best of 3, warm buffers)
+static double TimeSearch(const std::vector<double> &x, const std::vector<double> &y,
+                         unsigned int threads)
+{
+    unsigned int n = x.size();
+    std::vector<int> id(n);
+    for (unsigned int i=0; i<n; i++)
+        id[i] = i;
+    std::vector<char> need(n, 1);
+    neighbor_list NL;
+    voronoi_scratch *S = NewVoronoiScratch();
+    double best = 0;
+    for (int rep=0; rep<4; rep++){
+        auto t0 = std::chrono::steady_clock::now();
+        if (threads > 0)
+            VoronoiNeighborsTiled(x, y, id, n, need, threads, NL, NULL, S);
+        else
+            VoronoiNeighbors(x, y, id, n, need, NL, S);
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (rep == 1 || (rep > 1 && t < best))  // rep 0: warm-up
+            best = t;
+        if (rep > 0 && t > CALIB_TMAX / 4)
+            break;
+    }
+    FreeVoronoiScratch(S);
+    return best;
+}
+
+
+static void Calibrate(engine_model &M)
+{
+    std::mt19937 gen(12345);    // own generator: the run stays reproducible
+    std::vector<double> x, y;
+    for (int l=0; l<2; l++){
+        M.occ[l].resize(0);
+        M.t[l].resize(0);
+    }
+    M.N.resize(0);
+    for (unsigned int n=CALIB_NMIN; n<=CALIB_NMAX; n*=4){
+        double tmax = 0;
+        for (int l=0; l<2; l++){
+            SyntheticPoints(n, l, gen, x, y);
+            M.occ[l].push_back(Occupancy(x, y, M.cells));
+            std::vector<double> t(M.threads.size());
+            for (unsigned int c=0; c<M.threads.size(); c++){
+                t[c] = TimeSearch(x, y, M.threads[c]);
+                tmax = std::max(tmax, t[c]);
+            }
+            M.t[l].push_back(t);
+        }
+        M.N.push_back(n);
+        if (tmax > CALIB_TMAX && M.N.size() > 1)
+            break;
+    }
+}
+
+
+static bool LoadModel(engine_model &M, std::string fname)
+{
+    std::ifstream in(fname.c_str());
+    if (!in.is_open())
+        return false;
+    std::string line, word;
+    std::vector<unsigned int> threads;
+    // header: candidates
+    while (std::getline(in, line) && line[0] == '#'){}
+    std::istringstream head(line);
+    head >> word;
+    if (word != "threads")
+        return false;
+    unsigned int k;
+    while (head >> k)
+        threads.push_back(k);
+    if (threads != M.threads)   // e.g. other OMP_NUM_THREADS
+        return false;
+    // rows: N occ_uniform occ_clustered t_uniform[c]... t_clustered[c]...
+    M.N.resize(0);
+    for (int l=0; l<2; l++){
+        M.occ[l].resize(0);
+        M.t[l].resize(0);
+    }
+    while (std::getline(in, line)){
+        std::istringstream row(line);
+        double n, o0, o1;
+        if (!(row >> n >> o0 >> o1))
+            continue;
+        std::vector<double> t0(threads.size()), t1(threads.size());
+        for (unsigned int c=0; c<threads.size(); c++)
+            row >> t0[c];
+        for (unsigned int c=0; c<threads.size(); c++)
+            row >> t1[c];
+        if (row.fail())
+            return false;
+        M.N.push_back(n);
+        M.occ[0].push_back(o0);
+        M.occ[1].push_back(o1);
+        M.t[0].push_back(t0);
+        M.t[1].push_back(t1);
+    }
+    return M.N.size() > 0;
+}
+
+
+static void SaveModel(const engine_model &M, std::string fname)
+{
+    // write a temporary file and replace the cache at once (concurrent runs
+    // never load a partial model)
+    std::string tmp = fname + ".tmp." + std::to_string(getpid());
+    std::ofstream out(tmp.c_str());
+    if (!out.is_open()){
+        std::cout<< "engine auto: model not cached (" << fname << ")" << std::endl;
+        return;
+    }
+    out << "# swarmdyn voronoi engine model: seconds per neighbor search\n"
+        << "# N occupancy(uniform, clustered) t_uniform(threads) t_clustered(threads)\n";
+    out << "threads";
+    for (unsigned int c=0; c<M.threads.size(); c++)
+        out << " " << M.threads[c];
+    out << "\n";
+    for (unsigned int n=0; n<M.N.size(); n++){
+        out << M.N[n] << " " << M.occ[0][n] << " " << M.occ[1][n];
+        for (int l=0; l<2; l++)
+            for (unsigned int c=0; c<M.threads.size(); c++)
+                out << " " << M.t[l][n][c];
+        out << "\n";
+    }
+    out.close();
+    if (out.fail() || rename(tmp.c_str(), fname.c_str()) != 0){
+        std::cout<< "engine auto: model not cached (" << fname << ")" << std::endl;
+        remove(tmp.c_str());
+    }
+}
+
+
+void InitEngineModel(engine_model &M)
+{
+    // candidates: serial, tiled with 2, 4, ... and all threads
+    unsigned int maxthreads = omp_get_max_threads();
+    M.threads.assign(1, 0);
+    for (unsigned int p=2; p<maxthreads; p*=2)
+        M.threads.push_back(p);
+    if (maxthreads > 1)
+        M.threads.push_back(maxthreads);
+    if (M.threads.size() == 1)
+        return;
+    std::string fname = CacheFile();
+    if (LoadModel(M, fname)){
+        std::cout<< "engine auto: model from " << fname << std::endl;
+        return;
+    }
+    std::cout<< "engine auto: calibration of " << M.threads.size()
+             << " candidates ..." << std::flush;
+    Calibrate(M);
+    SaveModel(M, fname);
+    std::cout<< " -> " << fname << std::endl;
+}
+
+
+// linear interpolation of v(logN), extrapolated with the outer segments
+static double Interp(const std::vector<double> &logN, const std::vector<double> &v,
+                     double logn)
+{
+    unsigned int n = logN.size();
+    if (n == 1)
+        return v[0];
+    unsigned int k = 1;
+    while (k < n - 1 && logN[k] < logn)
+        k++;
+    double w = (logn - logN[k-1]) / (logN[k] - logN[k-1]);
+    return v[k-1] + w * (v[k] - v[k-1]);
+}
+
+
+unsigned int PickVorThreads(engine_model &M, const std::vector<double> &x,
+                            const std::vector<double> &y, unsigned int current)
+{
+    if (M.threads.size() < 2 || M.N.size() == 0 || x.size() < 2)
+        return current;
+    double logn = log(static_cast<double>(x.size()));
+    std::vector<double> &logN = M.logN;
+    std::vector<double> &lt = M.lt;
+    logN.resize(M.N.size());
+    lt.resize(M.N.size());
+    for (unsigned int n=0; n<M.N.size(); n++)
+        logN[n] = log(M.N[n]);
+    // weight of the uniform layout from the occupancy
+    double o = Occupancy(x, y, M.cells);
+    double o0 = Interp(logN, M.occ[0], logn);
+    double o1 = Interp(logN, M.occ[1], logn);
+    double w = (o0 > o1) ? (o - o1) / (o0 - o1) : 1;
+    w = std::min(1., std::max(0., w));
+    unsigned int best = 0;
+    double tbest = 0, tcurrent = -1;
+    for (unsigned int c=0; c<M.threads.size(); c++){
+        double t = 0;
+        for (int l=0; l<2; l++){
+            for (unsigned int n=0; n<M.N.size(); n++)
+                lt[n] = log(std::max(M.t[l][n][c], 1e-9));
+            t += ((l == 0) ? w : 1 - w) * exp(Interp(logN, lt, logn));
+        }
+        if (c == 0 || t < tbest){
+            tbest = t;
+            best = c;
+        }
+        if (M.threads[c] == current)
+            tcurrent = t;
+    }
+    if (tcurrent >= 0 && tbest > (1 - AUTO_GAIN) * tcurrent)
+        return current;
+    return M.threads[best];
+}
+
+
+double Occupancy(const std::vector<double> &x, const std::vector<double> &y,
+                 std::vector<char> &cells)
+{
+    unsigned int n = x.size();
+    if (n == 0)
+        return 0;
+    double x0 = *std::min_element(x.begin(), x.end());
+    double x1 = *std::max_element(x.begin(), x.end());
+    double y0 = *std::min_element(y.begin(), y.end());
+    double y1 = *std::max_element(y.begin(), y.end());
+    double extent = std::max(x1 - x0, y1 - y0);
+    if (!(extent > 0))      // all points coincide
+        return 1;
+    // ~4 points per cell if uniform, at most ~sqrt(n) cells per side
+    // (collinear or degenerate positions: no tiny cells)
+    double cs = std::max(sqrt(4 * (x1 - x0) * (y1 - y0) / n), extent / sqrt(n));
+    int nx = std::min(OCC_MAXCELLS, static_cast<int>((x1 - x0) / cs) + 1);
+    int ny = std::min(OCC_MAXCELLS, static_cast<int>((y1 - y0) / cs) + 1);
+    cells.assign(nx * ny, 0);
+    for (unsigned int i=0; i<n; i++){
+        int ix = std::min(nx - 1, static_cast<int>((x[i] - x0) / cs));
+        int iy = std::min(ny - 1, static_cast<int>((y[i] - y0) / cs));
+        cells[iy * nx + ix] = 1;
+    }
+    unsigned int occupied = std::count(cells.begin(), cells.end(), 1);
+    return occupied / static_cast<double>(nx * ny);
+}
@@ -0,0 +1,60 @@
+/*  EngineSelect
+    calibrated cost model of the voronoi neighbor search (engine=-1: auto)
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef engine_select_H
+#define engine_select_H
+
+#include <string>
+#include <vector>
+
+// Only engines with identical results are candidates: the single (serial)
+// triangulation (vor_threads=0) and the tiled triangulation with 2, 4, ...
+// threads (voronoi_tiles.h, exact and independent of the # of threads).
+// kNN and global (engine=1) are different models and never picked.
+// The time of each candidate is measured once per machine on synthetic
+// configurations (uniform and clustered points at N = 2^8, 2^10, ...) and
+// cached in $SWARMDYN_CACHE or ~/.cache/swarmdyn/engine_model_<host>.dat.
+// During the run the cost of a candidate is interpolated in log(N) and
+// between the layouts by the occupancy of the current positions (a
+// scattered school, e.g. after predator attacks, is clustered).
+#define AUTO_EVERY 100      // steps between two picks
+#define AUTO_GAIN 0.1       // switch only if the predicted time is 10% lower
+
+struct engine_model{
+    std::vector<unsigned int> threads;  // candidates (vor_threads)
+    std::vector<double> N;              // calibrated # of points
+    // [layout][n]: occupancy, [layout][n][candidate]: seconds per search
+    std::vector<double> occ[2];
+    std::vector< std::vector<double> > t[2];
+    std::vector<char> cells;            // buffers of PickVorThreads
+    std::vector<double> logN, lt;       //  (no allocations after the 1st pick)
+};
+typedef struct engine_model engine_model;
+
+// loads the cached model of this machine or calibrates and caches it
+void InitEngineModel(engine_model &M);
+// vor_threads with the lowest predicted time (current: vor_threads in use)
+unsigned int PickVorThreads(engine_model &M, const std::vector<double> &x,
+                            const std::vector<double> &y, unsigned int current);
+// fraction of occupied cells of a grid with ~n/4 cells over the bounding box
+double Occupancy(const std::vector<double> &x, const std::vector<double> &y,
+                 std::vector<char> &cells);
+#endif
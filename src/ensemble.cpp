@@ -0,0 +1,496 @@
+/*  Ensemble
+    integrates many independent replicates of a small swarm in lockstep
+    (throughput mode for parameter fitting) for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "ensemble.h"
+
+
+void InitEnsemble(ensemble &ens, params *ptrSP, unsigned long seed)
+{
+    // allocates the replicate-major arrays and initializes each replicate
+    // with its own generator by the same routines as a single run
+    unsigned int R = ptrSP->Nrep;
+    unsigned int N = ptrSP->N;
+    unsigned int NR = N * R;
+    ens.R = R;
+    ens.N = N;
+    ens.x0.assign(NR, 0.);
+    ens.x1.assign(NR, 0.);
+    ens.v0.assign(NR, 0.);
+    ens.v1.assign(NR, 0.);
+    ens.u0.assign(NR, 0.);
+    ens.u1.assign(NR, 0.);
+    ens.phi.assign(NR, 0.);
+    ens.vproj.assign(NR, 0.);
+    ens.force0.assign(NR, 0.);
+    ens.force1.assign(NR, 0.);
+    ens.frep0.assign(NR, 0.);
+    ens.frep1.assign(NR, 0.);
+    ens.falg0.assign(NR, 0.);
+    ens.falg1.assign(NR, 0.);
+    ens.fatt0.assign(NR, 0.);
+    ens.fatt1.assign(NR, 0.);
+    ens.crep.assign(NR, 0.);
+    ens.calg.assign(NR, 0.);
+    ens.catt.assign(NR, 0.);
+    ens.bin_step.assign(NR, 0);
+    ens.steps_till_burst.assign(NR, 0);
+    ens.fb.assign(NR, 0.);
+    ens.voro.assign(N * N * R, 0.);
+    ens.NN.assign(N * N * R, 0.);
+    ens.lo.assign(R, 0.);
+    ens.hi.assign(R, 0.);
+    ens.draw_soc.assign(R, 0.);
+    ens.draw_phi.assign(R, 0.);
+    ens.force_mag.assign(R, 0.);
+    ens.first_burst.assign(R, 0);
+    ens.wall.assign(R, 0);
+    ens.probe.x.assign(2, 0.);
+    ens.probe.v.assign(2, 0.);
+    ens.probe.u.assign(2, 0.);
+    ens.probe.force.assign(2, 0.);
+
+    std::vector<particle> a(N);
+    ens.rng.resize(R);
+    for (unsigned int r=0; r<R; r++){
+        ens.rng[r] = gsl_rng_alloc(gsl_rng_default);
+        gsl_rng_set(ens.rng[r], seed + r);
+        InitSystem(a, *ptrSP);
+        ResetSystem(a, ptrSP, false, ens.rng[r]);
+        for (unsigned int i=0; i<N; i++){
+            unsigned int k = i * R + r;
+            ens.x0[k] = a[i].x[0];
+            ens.x1[k] = a[i].x[1];
+            ens.v0[k] = a[i].v[0];
+            ens.v1[k] = a[i].v[1];
+            ens.u0[k] = a[i].u[0];
+            ens.u1[k] = a[i].u[1];
+            ens.phi[k] = a[i].phi;
+            ens.vproj[k] = a[i].vproj;
+            ens.bin_step[k] = a[i].bin_step;
+            ens.steps_till_burst[k] = a[i].steps_till_burst;
+        }
+    }
+}
+
+
+void FreeEnsemble(ensemble &ens)
+{
+    for (unsigned int r=0; r<ens.rng.size(); r++)
+        gsl_rng_free(ens.rng[r]);
+    ens.rng.resize(0);
+}
+
+
+void EnsembleStep(ensemble &ens, params *ptrSP)
+{
+    // single integration step of all replicates (same order as Step)
+    unsigned int NR = ens.N * ens.R;
+    // interactions are only computed at start of burst
+    for (unsigned int k=0; k<NR; k++)
+        ens.fb[k] = (ens.bin_step[k] == ptrSP->burst_steps) ? 1 : 0;
+    EnsembleVoronoiNN(ens);
+    EnsembleInteraction(ens, ptrSP);
+    EnsembleBurstCoast(ens, ptrSP);
+}
+
+
+void EnsembleVoronoiNN(ensemble &ens)
+{
+    // brute force voronoi-neighbors (cheaper than CGAL for small N):
+    // i and j are delaunay-neighbors if a circle through i and j exists
+    // which contains no other agent k. The centers of all circles through
+    // i and j lie on the bisector c(t) = m + t * n (m = midpoint, n = perp(r_ij)).
+    // Each k restricts t to a half-line: c0 + c1 * t >= 0 with
+    //      c0 = |m - x_k|^2 - |m - x_i|^2,   c1 = 2 * n * (x_i - x_k)
+    // -> i, j are neighbors if the intersection [lo, hi] of all half-lines is not empty
+    // The test is only done if i or j starts a burst in any replicate.
+    unsigned int R = ens.R;
+    unsigned int N = ens.N;
+    double inf = std::numeric_limits<double>::infinity();
+    double *lo = &ens.lo[0];
+    double *hi = &ens.hi[0];
+    for (unsigned int i=0; i<N; i++){
+        const double *xi0 = &ens.x0[i * R];
+        const double *xi1 = &ens.x1[i * R];
+        const double *fbi = &ens.fb[i * R];
+        for (unsigned int j=i+1; j<N; j++){
+            const double *xj0 = &ens.x0[j * R];
+            const double *xj1 = &ens.x1[j * R];
+            const double *fbj = &ens.fb[j * R];
+            double *vij = &ens.voro[(i * N + j) * R];
+            double *vji = &ens.voro[(j * N + i) * R];
+            double needed = 0;
+            for (unsigned int r=0; r<R; r++)
+                needed += fbi[r] + fbj[r];
+            if (needed == 0){
+                std::fill(vij, vij + R, 0.);
+                std::fill(vji, vji + R, 0.);
+                continue;
+            }
+            for (unsigned int r=0; r<R; r++){
+                lo[r] = -inf;
+                hi[r] = inf;
+            }
+            for (unsigned int k=0; k<N; k++){
+                if (k == i || k == j)
+                    continue;
+                const double *xk0 = &ens.x0[k * R];
+                const double *xk1 = &ens.x1[k * R];
+                // arrays never overlap (too many runtime alias checks otherwise)
+#pragma GCC ivdep
+                for (unsigned int r=0; r<R; r++){
+                    double m0 = 0.5 * (xi0[r] + xj0[r]);
+                    double m1 = 0.5 * (xi1[r] + xj1[r]);
+                    double n0 = xi1[r] - xj1[r];
+                    double n1 = xj0[r] - xi0[r];
+                    double c0 = (m0 - xk0[r]) * (m0 - xk0[r]) + (m1 - xk1[r]) * (m1 - xk1[r])
+                              - (m0 - xi0[r]) * (m0 - xi0[r]) - (m1 - xi1[r]) * (m1 - xi1[r]);
+                    double c1 = 2 * (n0 * (xi0[r] - xk0[r]) + n1 * (xi1[r] - xk1[r]));
+                    double t = - c0 / c1;
+                    double tlo = (c1 > 0) ? t : -inf;
+                    double thi = (c1 < 0) ? t : inf;
+                    // c1 == 0: k on line through i, j -> blocks only if between i and j
+                    double blocked = (c0 < 0) ? 1 : 0;
+                    blocked = (c1 == 0) ? blocked : 0;
+                    tlo = (blocked > 0) ? inf : tlo;
+                    thi = (blocked > 0) ? -inf : thi;
+                    lo[r] = (tlo > lo[r]) ? tlo : lo[r];
+                    hi[r] = (thi < hi[r]) ? thi : hi[r];
+                }
+            }
+            for (unsigned int r=0; r<R; r++){
+                vij[r] = (lo[r] <= hi[r]) ? 1 : 0;
+                vji[r] = vij[r];
+            }
+        }
+    }
+}
+
+
+void EnsembleInteraction(ensemble &ens, params *ptrSP)
+{
+    // social forces of all voronoi-pairs (as IntCalcPrey with SFM_4Zone)
+    // computed with masks instead of branches
+    unsigned int R = ens.R;
+    unsigned int N = ens.N;
+    double rep_range = ptrSP->rep_range;
+    double alg_range = ptrSP->alg_range;
+    double att_range = ptrSP->att_range;
+    for (unsigned int i=0; i<N; i++){
+        unsigned int ki = i * R;
+        double *frep0 = &ens.frep0[ki];
+        double *frep1 = &ens.frep1[ki];
+        double *falg0 = &ens.falg0[ki];
+        double *falg1 = &ens.falg1[ki];
+        double *fatt0 = &ens.fatt0[ki];
+        double *fatt1 = &ens.fatt1[ki];
+        double *crep = &ens.crep[ki];
+        double *calg = &ens.calg[ki];
+        double *catt = &ens.catt[ki];
+        const double *fbi = &ens.fb[ki];
+        const double *xi0 = &ens.x0[ki];
+        const double *xi1 = &ens.x1[ki];
+        for (unsigned int j=0; j<N; j++){
+            if (j == i)
+                continue;
+            unsigned int kj = j * R;
+            const double *xj0 = &ens.x0[kj];
+            const double *xj1 = &ens.x1[kj];
+            const double *vj0 = &ens.v0[kj];
+            const double *vj1 = &ens.v1[kj];
+            const double *voro = &ens.voro[(i * N + j) * R];
+            double *NN = &ens.NN[(i * N + j) * R];
+#pragma GCC ivdep
+            for (unsigned int r=0; r<R; r++){
+                double m = voro[r] * fbi[r];
+                double r0 = xj0[r] - xi0[r];
+                double r1 = xj1[r] - xi1[r];
+                double dist = sqrt(r0 * r0 + r1 * r1);
+                double inv = (dist > 0) ? 1 / dist : 0;
+                double u0 = r0 * inv;
+                double u1 = r1 * inv;
+                double rep = (dist <= rep_range) ? m : 0;
+                double alg = (dist > rep_range && dist <= alg_range) ? m : 0;
+                double att = (dist > alg_range && dist <= att_range) ? m : 0;
+                frep0[r] -= rep * u0;
+                frep1[r] -= rep * u1;
+                falg0[r] += alg * vj0[r];
+                falg1[r] += alg * vj1[r];
+                fatt0[r] += att * u0;
+                fatt1[r] += att * u1;
+                crep[r] += rep;
+                calg[r] += alg;
+                catt[r] += att;
+                NN[r] = rep + alg + att;
+            }
+        }
+    }
+}
+
+
+void EnsembleBurstCoast(ensemble &ens, params *ptrSP)
+{
+    // ParticleBurstCoast of all agents in all replicates:
+    //  -random numbers are drawn per replicate (scalar, 1 stream each)
+    //  -force selection, future position and kinematics are branch free
+    //  -the rare wall-avoidance (closestForceDirection) falls back to the scalar code
+    unsigned int R = ens.R;
+    unsigned int N = ens.N;
+    unsigned int burst_steps = ptrSP->burst_steps;
+    int BC = ptrSP->BC;
+    double dt = ptrSP->dt;
+    double alphaTurn = ptrSP->alphaTurn;
+    double sizeL = ptrSP->sizeL;
+    double prob_social = ptrSP->prob_social;
+    double soc_strength = ptrSP->soc_strength;
+    double env_strength = ptrSP->env_strength;
+    // exact propagator over 1 step (see kinematics.h)
+    double decay1 = ptrSP->prop.decay[1];
+    double gain1 = ptrSP->prop.gain[1];
+    double disp1 = ptrSP->prop.disp[1];
+    double *draw_soc = &ens.draw_soc[0];
+    double *draw_phi = &ens.draw_phi[0];
+    double *force_mag = &ens.force_mag[0];
+    unsigned char *first_burst = &ens.first_burst[0];
+    unsigned char *wall = &ens.wall[0];
+    for (unsigned int i=0; i<N; i++){
+        unsigned int ki = i * R;
+        double *x0 = &ens.x0[ki];
+        double *x1 = &ens.x1[ki];
+        double *v0 = &ens.v0[ki];
+        double *v1 = &ens.v1[ki];
+        double *u0 = &ens.u0[ki];
+        double *u1 = &ens.u1[ki];
+        double *phi = &ens.phi[ki];
+        double *vproj = &ens.vproj[ki];
+        double *force0 = &ens.force0[ki];
+        double *force1 = &ens.force1[ki];
+        unsigned int *bin_step = &ens.bin_step[ki];
+        unsigned int *steps_till_burst = &ens.steps_till_burst[ki];
+
+        // 1. random numbers for the burst decision
+        for (unsigned int r=0; r<R; r++){
+            first_burst[r] = (bin_step[r] == burst_steps);
+            if (first_burst[r]){
+                draw_soc[r] = gsl_rng_uniform(ens.rng[r]);
+                if (draw_soc[r] > prob_social)
+                    draw_phi[r] = 2 * M_PI * gsl_rng_uniform(ens.rng[r]);
+            }
+        }
+        // 2. burst force (draw_social_or_environmental_force)
+        for (unsigned int r=0; r<R; r++){
+            unsigned int k = ki + r;
+            bool fb = first_burst[r];
+            bool social = (draw_soc[r] <= prob_social);
+            // social: repulsion dominates, otherwise weighted alignment + attraction
+            double lalg = sqrt(ens.falg0[k] * ens.falg0[k] + ens.falg1[k] * ens.falg1[k]);
+            double latt = sqrt(ens.fatt0[k] * ens.fatt0[k] + ens.fatt1[k] * ens.fatt1[k]);
+            double walg = (lalg > 0) ? ens.calg[k] / lalg : 0;
+            double watt = (latt > 0) ? ens.catt[k] / latt : 0;
+            bool rep = (ens.crep[k] > 0);
+            double s0 = rep ? ens.frep0[k] : walg * ens.falg0[k] + watt * ens.fatt0[k];
+            double s1 = rep ? ens.frep1[k] : walg * ens.falg1[k] + watt * ens.fatt1[k];
+            double ls = sqrt(s0 * s0 + s1 * s1);
+            // if no social-force -> swim straight
+            s0 = (ls > 0) ? s0 / ls : cos(phi[r]);
+            s1 = (ls > 0) ? s1 / ls : sin(phi[r]);
+            // environmental: random direction
+            double e0 = cos(draw_phi[r]);
+            double e1 = sin(draw_phi[r]);
+            double mag = social ? soc_strength : env_strength;
+            double f0 = mag * (social ? s0 : e0);
+            double f1 = mag * (social ? s1 : e1);
+            force_mag[r] = fb ? mag : soc_strength;
+            // WALL: position shortly after next burst (predictXatNextBurst)
+            wall[r] = 0;
+            if (BC >= 5){
+                double cv, cf;
+                predictCoefficients(ptrSP->prop, steps_till_burst[r], cv, cf);
+                double xf0 = x0[r] + cv * v0[r] + cf * f0;
+                double xf1 = x1[r] + cv * v1[r] + cf * f1;
+                wall[r] = fb && (sqrt(xf0 * xf0 + xf1 * xf1) > sizeL - 2);
+            }
+            // burst-mode: keep initial force, coast-mode: no force
+            bool bursting = (bin_step[r] > 0);
+            force0[r] = fb ? f0 : (bursting ? force0[r] : 0);
+            force1[r] = fb ? f1 : (bursting ? force1[r] : 0);
+        }
+        // scalar fallback: force closest to intended force which avoids the wall
+        if (BC >= 5){
+            for (unsigned int r=0; r<R; r++){
+                if (!wall[r])
+                    continue;
+                ens.probe.x[0] = x0[r];
+                ens.probe.x[1] = x1[r];
+                ens.probe.v[0] = v0[r];
+                ens.probe.v[1] = v1[r];
+                ens.probe.force[0] = force0[r];
+                ens.probe.force[1] = force1[r];
+                ens.probe.steps_till_burst = steps_till_burst[r];
+                double angle = closestForceDirection(ens.probe, ptrSP);
+                force0[r] = force_mag[r] * cos(angle);
+                force1[r] = force_mag[r] * sin(angle);
+            }
+        }
+        // 3. kinematics
+        for (unsigned int r=0; r<R; r++){
+            unsigned int k = ki + r;
+            double f0 = force0[r];
+            double f1 = force1[r];
+            bin_step[r] -= (bin_step[r] > 0);
+            steps_till_burst[r] -= (steps_till_burst[r] > 0);
+            double lphi = phi[r];
+            double vp = vproj[r];
+            // speed adjustment
+            double forcev = f0 * cos(lphi) + f1 * sin(lphi);
+            double vnew = decay1 * vp + gain1 * forcev;
+            double dx = gain1 * vp + disp1 * forcev;
+            // prevents F of swimming back
+            bool back = (vnew < 0);
+            vnew = back ? 0.001 : vnew;
+            dx = back ? vnew * dt : dx;
+            lphi += back ? M_PI / 2 : 0;
+            // normal turn:
+            double forcep = -f0 * sin(lphi) + f1 * cos(lphi);
+            lphi += alphaTurn * forcep * dt / vp;
+            // overshoot_check
+            double nu0 = cos(lphi);
+            double nu1 = sin(lphi);
+            double angForceV0 = acos((u0[r] * f0 + u1[r] * f1) / force_mag[r]);
+            double angForceV1 = acos((nu0 * f0 + nu1 * f1) / force_mag[r]);
+            double angV0V1 = acos(nu0 * u0[r] + nu1 * u1[r]);
+            double dphi = fabs(lphi - phi[r]);
+            bool OvershootI = (angForceV0 < angForceV1);
+            bool OvershootII = !OvershootI && (angV0V1 > angForceV0);
+            bool OvershootIII = dphi > M_PI;
+            bool overshoot = (dphi > 0.01) && (OvershootI || OvershootII || OvershootIII);
+            lphi = overshoot ? atan2(f1, f0) : lphi;
+            lphi = fmod(lphi, 2*M_PI);
+            phi[r] = lphi;
+            u0[r] = cos(lphi);
+            u1[r] = sin(lphi);
+            vproj[r] = vnew;
+            v0[r] = vnew * u0[r];
+            v1[r] = vnew * u1[r];
+            x0[r] += dx * u0[r];
+            x1[r] += dx * u1[r];
+            // Reset all forces
+            ens.frep0[k] = ens.frep1[k] = 0.0;
+            ens.falg0[k] = ens.falg1[k] = 0.0;
+            ens.fatt0[k] = ens.fatt1[k] = 0.0;
+            ens.crep[k] = ens.calg[k] = ens.catt[k] = 0.0;
+        }
+        EnsembleBoundary(ens, i, sizeL, BC);
+        // 4. next burst (second consider_boundary of ParticleBurstCoast is
+        //    a no-op since the position is not changed in between)
+        for (unsigned int r=0; r<R; r++){
+            if (steps_till_burst[r] == 0){
+                bin_step[r] = burst_steps;
+                steps_till_burst[r] = DrawStepsTillBurst(ptrSP, ens.rng[r]);
+            }
+        }
+    }
+}
+
+
+void EnsembleBoundary(ensemble &ens, unsigned int i, double sizeL, int BC)
+{
+    // Boundary of agent i in all replicates:
+    // circular tank (BC=5, 6) branch free, boxes via the scalar Boundary
+    unsigned int R = ens.R;
+    unsigned int ki = i * R;
+    double *x0 = &ens.x0[ki];
+    double *x1 = &ens.x1[ki];
+    double *v0 = &ens.v0[ki];
+    double *v1 = &ens.v1[ki];
+    double *u0 = &ens.u0[ki];
+    double *u1 = &ens.u1[ki];
+    double *phi = &ens.phi[ki];
+    if (BC == -1)
+        return;
+    if (BC == 5 || BC == 6){
+        // elastic: mirror velocity, inelastic: remove normal component
+        double reflect = (BC == 5) ? 2 : 1;
+        for (unsigned int r=0; r<R; r++){
+            double dist2cen = sqrt(x0[r] * x0[r] + x1[r] * x1[r]);
+            double diff = dist2cen - sizeL;
+            bool outside = (diff > 0);
+            double n0 = outside ? x0[r] / dist2cen : 0;
+            double n1 = outside ? x1[r] / dist2cen : 0;
+            double corr = outside ? 2 * diff : 0;
+            x0[r] -= corr * n0;
+            x1[r] -= corr * n1;
+            double vn = outside ? reflect * (n0 * v0[r] + n1 * v1[r]) : 0;
+            v0[r] -= vn * n0;
+            v1[r] -= vn * n1;
+            double speed = sqrt(v0[r] * v0[r] + v1[r] * v1[r]);
+            u0[r] = outside ? v0[r] / speed : u0[r];
+            u1[r] = outside ? v1[r] / speed : u1[r];
+            phi[r] = outside ? atan2(u1[r], u0[r]) : phi[r];
+        }
+        return;
+    }
+    for (unsigned int r=0; r<R; r++){
+        ens.probe.x[0] = x0[r];
+        ens.probe.x[1] = x1[r];
+        ens.probe.v[0] = v0[r];
+        ens.probe.v[1] = v1[r];
+        ens.probe.u[0] = u0[r];
+        ens.probe.u[1] = u1[r];
+        ens.probe.phi = phi[r];
+        Boundary(ens.probe, sizeL, BC);
+        x0[r] = ens.probe.x[0];
+        x1[r] = ens.probe.x[1];
+        v0[r] = ens.probe.v[0];
+        v1[r] = ens.probe.v[1];
+        u0[r] = ens.probe.u[0];
+        u1[r] = ens.probe.u[1];
+        phi[r] = ens.probe.phi;
+    }
+}
+
+
+void EnsembleGetReplicate(ensemble &ens, unsigned int r, std::vector<particle> &a)
+{
+    // assumes a was initialized by InitSystem with N agents
+    unsigned int R = ens.R;
+    unsigned int N = ens.N;
+    for (unsigned int i=0; i<N; i++){
+        unsigned int k = i * R + r;
+        a[i].x[0] = ens.x0[k];
+        a[i].x[1] = ens.x1[k];
+        a[i].v[0] = ens.v0[k];
+        a[i].v[1] = ens.v1[k];
+        a[i].u[0] = ens.u0[k];
+        a[i].u[1] = ens.u1[k];
+        a[i].phi = ens.phi[k];
+        a[i].vproj = ens.vproj[k];
+        a[i].force[0] = ens.force0[k];
+        a[i].force[1] = ens.force1[k];
+        a[i].bin_step = ens.bin_step[k];
+        a[i].steps_till_burst = ens.steps_till_burst[k];
+        a[i].id = i;
+        a[i].NN.resize(0);
+        for (unsigned int j=0; j<N; j++)
+            if (ens.NN[(i * N + j) * R + r] > 0)
+                a[i].NN.push_back(j);
+    }
+}
@@ -0,0 +1,76 @@
+/*  Ensemble
+    integrates many independent replicates of a small swarm in lockstep
+    (throughput mode for parameter fitting) for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef ensemble_H
+#define ensemble_H
+// OWN MODULES:
+#include "common_defines.h"
+#include "agents.h"
+#include "agents_dynamics.h"
+#include "mathtools.h"
+#include "settings.h"
+
+#include <vector>
+#include <gsl/gsl_rng.h>
+
+// Replicate-major structure of arrays:
+// the property of agent i in replicate r is stored at [i * R + r], thus
+// every loop over the replicates runs over contiguous memory and the
+// compiler can vectorize across replicates (N is small, R is large).
+// Only the burst-coast scenario is supported (no predator, BC = -1, 5, 6).
+struct ensemble{
+    unsigned int R;                     // number of replicates
+    unsigned int N;                     // number of agents per replicate
+    std::vector<double> x0, x1;         // position
+    std::vector<double> v0, v1;         // velocity
+    std::vector<double> u0, u1;         // direction unit vector
+    std::vector<double> phi;            // polar angle
+    std::vector<double> vproj;          // vel along heading direction
+    std::vector<double> force0, force1; // burst force
+    std::vector<double> frep0, frep1;   // repulsion
+    std::vector<double> falg0, falg1;   // alignment
+    std::vector<double> fatt0, fatt1;   // attraction
+    std::vector<double> crep, calg, catt;   // counters (double -> branch free accumulation)
+    std::vector<unsigned int> bin_step;
+    std::vector<unsigned int> steps_till_burst;
+    // masks are stored as double (0 or 1) to vectorize together with positions:
+    std::vector<double> fb;             // 1 if agent starts burst (computes interactions)
+    std::vector<double> voro;           // voro[(i * N + j) * R + r] = 1 if i, j are voronoi-NN
+    std::vector<double> NN;             // NN[(i * N + j) * R + r] = 1 if j interacted with i
+    std::vector<gsl_rng*> rng;          // one generator per replicate
+    // scratch (length R) reused every step:
+    std::vector<double> lo, hi;         // voronoi test: interval of empty-circle centers
+    std::vector<double> draw_soc, draw_phi, force_mag;
+    std::vector<unsigned char> first_burst, wall;
+    particle probe;                     // scalar fallback for wall avoidance
+};
+typedef struct ensemble ensemble;
+
+void InitEnsemble(ensemble &ens, params *ptrSP, unsigned long seed);
+void FreeEnsemble(ensemble &ens);
+void EnsembleStep(ensemble &ens, params *ptrSP);
+void EnsembleVoronoiNN(ensemble &ens);
+void EnsembleInteraction(ensemble &ens, params *ptrSP);
+void EnsembleBurstCoast(ensemble &ens, params *ptrSP);
+void EnsembleBoundary(ensemble &ens, unsigned int i, double sizeL, int BC);
+// copies replicate r to the particle-vector "a" (needed for output)
+void EnsembleGetReplicate(ensemble &ens, unsigned int r, std::vector<particle> &a);
+#endif
@@ -116,7 +116,7 @@ const char* getCmdOption(char ** begin, char ** end, const std::string & option)
 void ParseParameters(int argc, char **argv, params *SysParams)
 {
     // Function for parsing the parameters from command line
-    // free short option arguments: y, Z
+    // free short option arguments: q, v, z, U
     SysParams->sizeL = atof(getCmdOption(argv, argv+argc, "-L"));
     SysParams->location = getCmdOption(argv, argv+argc, "-l");
     SysParams->N = atoi(getCmdOption(argv, argv+argc, "-N"));
@@ -145,10 +145,26 @@ void ParseParameters(int argc, char **argv, params *SysParams)
     SysParams->pred_move = atoi(getCmdOption(argv, argv+argc, "-X"));
     SysParams->fileID = getCmdOption(argv, argv+argc, "-E");
     SysParams->out_h5 = atoi(getCmdOption(argv, argv+argc, "-J"));
+    SysParams->timing = atoi(getCmdOption(argv, argv+argc, "-M"));
+    SysParams->trace_every = atoi(getCmdOption(argv, argv+argc, "-Z"));
+    SysParams->alloc_check = atoi(getCmdOption(argv, argv+argc, "-K"));
+    SysParams->seed = strtoul(getCmdOption(argv, argv+argc, "-g"), NULL, 10);
+    SysParams->progress = atof(getCmdOption(argv, argv+argc, "-p"));
     SysParams->prob_social = atof(getCmdOption(argv, argv+argc, "-Q"));
     SysParams->burst_duration = atof(getCmdOption(argv, argv+argc, "-u"));
     SysParams->alphaTurn = atof(getCmdOption(argv, argv+argc, "-Y"));
     SysParams->kill_rate = atof(getCmdOption(argv, argv+argc, "-O"));
+    SysParams->Nrep = atoi(getCmdOption(argv, argv+argc, "-y"));
+    SysParams->kNN = atoi(getCmdOption(argv, argv+argc, "-k"));
+    SysParams->engine = atoi(getCmdOption(argv, argv+argc, "-j"));
+    SysParams->sfm = atoi(getCmdOption(argv, argv+argc, "-F"));
+    SysParams->sort_every = atoi(getCmdOption(argv, argv+argc, "-C"));
+    SysParams->vor_threads = atoi(getCmdOption(argv, argv+argc, "-V"));
+    SysParams->burst_dist = atoi(getCmdOption(argv, argv+argc, "-i"));
+    SysParams->burst_shape = atof(getCmdOption(argv, argv+argc, "-s"));
+    SysParams->burst_file = getCmdOption(argv, argv+argc, "-P");
+    SysParams->arena_file = getCmdOption(argv, argv+argc, "-W");
+    SysParams->arena_res = atof(getCmdOption(argv, argv+argc, "-w"));
     // Sets auxillary variables
     if(SysParams->output>SysParams->dt)
         SysParams->step_output=(int) (SysParams->output/SysParams->dt);
@@ -166,6 +182,7 @@ void OutputParameters(params SysParams)
     fprintf(fp,"[Parameters]\n");
     fprintf(fp,"size:               \t%g\n",SysParams.sizeL);
     fprintf(fp,"particles:          \t%d\n",SysParams.N);
+    fprintf(fp,"replicates:         \t%d\n",SysParams.Nrep);
     fprintf(fp,"dt:                 \t%g\n",SysParams.dt);
     fprintf(fp,"time:               \t%g\n",SysParams.sim_time);
     fprintf(fp,"trans_time:         \t%g\n",SysParams.trans_time);
@@ -173,9 +190,17 @@ void OutputParameters(params SysParams)
     fprintf(fp,"rep_range:          \t%g\n",SysParams.rep_range);
     fprintf(fp,"alg_range:          \t%g\n",SysParams.alg_range);
     fprintf(fp,"att_range:          \t%g\n",SysParams.att_range);
+    fprintf(fp,"kNN:                \t%d\n",SysParams.kNN);
+    fprintf(fp,"engine:             \t%d\n",SysParams.engine);
+    fprintf(fp,"sfm:                \t%d\n",SysParams.sfm);
+    fprintf(fp,"sort_every:         \t%d\n",SysParams.sort_every);
+    fprintf(fp,"vor_threads:        \t%d\n",SysParams.vor_threads);
     fprintf(fp,"soc_strength:       \t%g\n",SysParams.soc_strength);
     fprintf(fp,"prob_social:       \t%g\n",SysParams.prob_social);
     fprintf(fp,"burst_rate:         \t%g\n",SysParams.burst_rate);
+    fprintf(fp,"burst_dist:         \t%d\n",SysParams.burst_dist);
+    fprintf(fp,"burst_shape:        \t%g\n",SysParams.burst_shape);
+    fprintf(fp,"burst_file:         \t%s\n",SysParams.burst_file.c_str());
     fprintf(fp,"env_strength:       \t%g\n",SysParams.env_strength);
     fprintf(fp,"beta:               \t%g\n",SysParams.beta);
 
@@ -188,11 +213,18 @@ void OutputParameters(params SysParams)
     fprintf(fp,"N_confu:            \t%d\n",SysParams.N_confu);
     fprintf(fp,"output:             \t%g\n",SysParams.output);
     fprintf(fp,"BC:                 \t%d\n",SysParams.BC);
+    fprintf(fp,"arena:              \t%s\n",SysParams.arena_file.c_str());
+    fprintf(fp,"arena_res:          \t%g\n",SysParams.arena_res);
     fprintf(fp,"IC:                 \t%d\n",SysParams.IC);
     fprintf(fp,"predator_circle_rad:\t%g\n",SysParams.kill_range);
     fprintf(fp,"pred_kill:          \t%d\n",SysParams.pred_kill);
     fprintf(fp,"pred_move:          \t%d\n",SysParams.pred_move);
     fprintf(fp,"out_h5:             \t%d\n",SysParams.out_h5);
+    fprintf(fp,"timing:             \t%d\n",SysParams.timing);
+    fprintf(fp,"trace_every:        \t%d\n",SysParams.trace_every);
+    fprintf(fp,"alloc_check:        \t%d\n",SysParams.alloc_check);
+    fprintf(fp,"seed:               \t%lu\n",SysParams.seed);
+    fprintf(fp,"progress:           \t%g\n",SysParams.progress);
     fprintf(fp,"burst_duration:     \t%g\n",SysParams.burst_duration);
     fprintf(fp,"alphaTurn:          \t%g\n",SysParams.alphaTurn);
     fprintf(fp,"kill_rate:          \t%g\n",SysParams.kill_rate);
@@ -32,6 +32,8 @@
 
 #include "agents.h" 
 
+// value following option in argv ("0" if missing)
+const char* getCmdOption(char ** begin, char ** end, const std::string & option);
 void ParseParameters(int argc, char **argv, params *SysParams);
 void OutputParameters(params SysParams);
 void LoadCoordinatesCPP(params * ptrSP, std::string name, std::vector<particle> &a);
@@ -0,0 +1,60 @@
+/*  Kinematics
+    exact propagators of the burst-coast equation of motion
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "kinematics.h"
+
+#include <cmath>
+
+
+void InitPropagator(propagator &P, double beta, double dt,
+                    unsigned int burst_steps, unsigned int kmax)
+{
+    P.kmax = kmax;
+    P.burst_steps = burst_steps;
+    P.beta = beta;
+    P.dt = dt;
+    P.decay.resize(kmax + 1);
+    P.gain.resize(kmax + 1);
+    P.disp.resize(kmax + 1);
+    P.pred_v.resize(kmax + 1);
+    P.pred_f.resize(kmax + 1);
+    for (unsigned int k=0; k<=kmax; k++){
+        P.decay[k] = exp(-beta * k * dt);
+        P.gain[k] = (1 - P.decay[k]) / beta;
+        P.disp[k] = (k * dt - P.gain[k]) / beta;
+    }
+    for (unsigned int k=0; k<=kmax; k++)
+        predictCoefficients(dt * burst_steps, dt * k, beta, P.pred_v[k], P.pred_f[k]);
+}
+
+
+void predictCoefficients(double t_burst, double t_tnb, double friction,
+                         double &cv, double &cf)
+{
+    // predictXatNextBurst is linear in the velocity and the force:
+    //      x_anb = x + cv * v + cf * force
+    // with the same burst time tb and coast time t_tnb - tb.
+    double tb = fmin(t_burst, t_tnb);
+    double eb = exp(-friction * tb);
+    double ec = exp(-friction * (t_tnb - tb));
+    cv = (1 - eb * ec) / friction;
+    cf = tb / friction - (1 - eb) * ec / (friction * friction);
+}
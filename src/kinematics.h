@@ -0,0 +1,63 @@
+/*  Kinematics
+    exact propagators of the burst-coast equation of motion
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef kinematics_H
+#define kinematics_H
+
+#include <vector>
+
+// dv/dt = -beta * v + F with F constant over k time steps has the solution:
+//      v(k dt) = decay[k] * v + gain[k] * F
+//      x(k dt) = x + gain[k] * v + disp[k] * F
+// beta, dt and burst_steps are fixed for a run and the steps till the next
+// burst are integer -> all coefficients are tabulated up to the maximum
+// inter-burst interval kmax (see DrawStepsTillBurst)
+struct propagator{
+    unsigned int kmax;
+    unsigned int burst_steps;
+    double beta, dt;
+    std::vector<double> decay;  // exp(-beta k dt)
+    std::vector<double> gain;   // (1 - decay[k]) / beta
+    std::vector<double> disp;   // (k dt - gain[k]) / beta
+    // position at next burst x_anb = x + pred_v[k] * v + pred_f[k] * F
+    // with k = steps_till_burst (see predictXatNextBurst)
+    std::vector<double> pred_v;
+    std::vector<double> pred_f;
+};
+typedef struct propagator propagator;
+
+void InitPropagator(propagator &P, double beta, double dt,
+                    unsigned int burst_steps, unsigned int kmax);
+void predictCoefficients(double t_burst, double t_tnb, double friction,
+                         double &cv, double &cf);
+
+// table lookup of predictCoefficients (computed if k > kmax)
+inline void predictCoefficients(const propagator &P, unsigned int k,
+                                double &cv, double &cf)
+{
+    if (k <= P.kmax){
+        cv = P.pred_v[k];
+        cf = P.pred_f[k];
+    }
+    else
+        predictCoefficients(P.dt * P.burst_steps, P.dt * k, P.beta, cv, cf);
+}
+#endif
@@ -143,6 +143,14 @@ std::vector<double> vec_set_mag(std::vector<T> &vec, double mag){
     return vec_out;
 }
 
+// vec_set_mag221 = sets magnitude of input vector (in place, no allocation)
+template<class T>
+void vec_set_mag221(std::vector<T> &vec, double mag){
+    double mag_current = vec_length(vec);
+    double correction = mag / mag_current;
+    vec_mul221(vec, correction);
+}
+
 
 template<class T, class T1>
 std::vector<double> vec_div(std::vector<T> &vec, T1 denom){
@@ -0,0 +1,369 @@
+/*  PhaseTimers
+    runtime-switchable timers of the phases of a step
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "phase_timers.h"
+#include "h5tools.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+void InitPhaseTimers(phase_timers &T, bool on)
+{
+    T.on = on;
+    T.calls.assign(on ? PH_N : 0, 0);
+    T.total.assign(on ? PH_N : 0, 0);
+    T.max.assign(on ? PH_N : 0, 0);
+    T.hist.assign(on ? PH_N * TIMER_BINS : 0, 0);
+    T.allocs.assign(on ? PH_N : 0, 0);
+    T.foreign.assign(on ? PH_N : 0, 0);
+    if (on)
+        AllocCounting(true);
+    T.start = std::chrono::steady_clock::now();
+    T.trace_every = 0;
+    T.trace = false;
+    T.step = 0;
+    T.trace_file = NULL;
+    T.events.resize(0);
+    T.hw_on = false;
+    for (int k=0; k<HW_N; k++)
+        T.hw_fd[k] = -1;
+    T.hw.resize(0);
+}
+
+
+void InitPhaseTrace(phase_timers &T, unsigned int trace_every, std::string fname)
+{
+    if (trace_every == 0)
+        return;
+    T.trace_file = fopen(fname.c_str(), "w");
+    if (T.trace_file == NULL){
+        std::cout<< "can not open " << fname << ": no trace" << std::endl;
+        return;
+    }
+    T.trace_every = trace_every;
+    fprintf(T.trace_file, "[\n");
+    fprintf(T.trace_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                          "\"tid\":0,\"args\":{\"name\":\"main\"}}");
+}
+
+
+void TraceSample(phase_timers &T, int step, unsigned int count)
+{
+    T.trace = (T.trace_every > 0 && count % T.trace_every == 0);
+    T.step = step;
+}
+
+
+void AddTraceEvent(phase_timers &T, const char *name,
+                   std::chrono::steady_clock::time_point t0,
+                   std::chrono::steady_clock::time_point t1, int tid)
+{
+    trace_event e;
+    e.name = name;
+    e.ts = std::chrono::duration<double, std::micro>(t0 - T.start).count();
+    e.dur = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    e.tid = tid;
+    e.step = T.step;
+    #pragma omp critical(phase_trace)
+    T.events.push_back(e);
+}
+
+
+void FlushTrace(phase_timers &T)
+{
+    if (T.trace_file == NULL)
+        return;
+    for (unsigned int k=0; k<T.events.size(); k++)
+        fprintf(T.trace_file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+                "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"step\":%d}}",
+                T.events[k].name, T.events[k].tid, T.events[k].ts,
+                T.events[k].dur, T.events[k].step);
+    T.events.resize(0);
+}
+
+
+void CloseTrace(phase_timers &T)
+{
+    if (T.trace_file == NULL)
+        return;
+    FlushTrace(T);
+    fprintf(T.trace_file, "\n]\n");
+    fclose(T.trace_file);
+    T.trace_file = NULL;
+    T.trace = false;
+}
+
+
+void AddPhaseTime(phase_timers &T, int phase, double sec)
+{
+    T.calls[phase]++;
+    T.total[phase] += sec;
+    T.max[phase] = fmax(T.max[phase], sec);
+    double b = floor(log2(fmax(sec * 1e9, 1)) * TIMER_BINS_PER_OCTAVE);
+    int bin = (b < TIMER_BINS - 1) ? static_cast<int>(b) : TIMER_BINS - 1;
+    T.hist[phase * TIMER_BINS + bin]++;
+}
+
+
+const char *CounterName(int counter)
+{
+    const char *names[HW_N] = {"cycles", "instructions", "cache_misses",
+                               "branch_misses", "task_clock"};
+    return names[counter];
+}
+
+
+void InitPhaseCounters(phase_timers &T)
+{
+    T.hw.assign(PH_N * HW_N, 0);
+#ifdef __linux__
+    unsigned int type[HW_N] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                               PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                               PERF_TYPE_SOFTWARE};
+    unsigned long long config[HW_N] = {PERF_COUNT_HW_CPU_CYCLES,
+                                       PERF_COUNT_HW_INSTRUCTIONS,
+                                       PERF_COUNT_HW_CACHE_MISSES,
+                                       PERF_COUNT_HW_BRANCH_MISSES,
+                                       PERF_COUNT_SW_TASK_CLOCK};
+    for (int k=0; k<HW_N; k++){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type[k];
+        attr.config = config[k];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // this thread on any cpu
+        T.hw_fd[k] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        T.hw_on = T.hw_on || (T.hw_fd[k] >= 0);
+    }
+#endif
+    std::cout<< "counters:";
+    for (int k=0; k<HW_N; k++)
+        std::cout<< " " << CounterName(k) << ((T.hw_fd[k] >= 0) ? "" : "(n/a)");
+    std::cout<< std::endl;
+    for (int k=0; k<HW_N; k++)
+        if (T.hw_fd[k] < 0)
+            for (int ph=0; ph<PH_N; ph++)
+                T.hw[ph * HW_N + k] = std::numeric_limits<double>::quiet_NaN();
+}
+
+
+void ReadPhaseCounters(const phase_timers &T, long long c[HW_N])
+{
+    for (int k=0; k<HW_N; k++){
+        c[k] = 0;
+#ifdef __linux__
+        if (T.hw_fd[k] >= 0 && read(T.hw_fd[k], &c[k], sizeof(c[k])) != sizeof(c[k]))
+            c[k] = 0;
+#endif
+    }
+}
+
+
+void ClosePhaseCounters(phase_timers &T)
+{
+#ifdef __linux__
+    for (int k=0; k<HW_N; k++)
+        if (T.hw_fd[k] >= 0)
+            close(T.hw_fd[k]);
+#endif
+    for (int k=0; k<HW_N; k++)
+        T.hw_fd[k] = -1;
+    T.hw_on = false;
+}
+
+
+double PeakRSS()
+{
+    // VmHWM: high water mark of the resident set of this program (after exec,
+    // unlike getrusage which includes the memory of the forking parent)
+    double kb = 0;
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key){
+        if (key == "VmHWM:"){
+            status >> kb;
+            break;
+        }
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return kb / 1024;
+}
+
+
+double PhasePercentile(const phase_timers &T, int phase, double q)
+{
+    // center of the histogram bin containing the q-quantile (seconds)
+    if (T.calls[phase] == 0)
+        return 0;
+    double target = q * T.calls[phase];
+    unsigned long long cum = 0;
+    int bin = TIMER_BINS - 1;
+    for (int b=0; b<TIMER_BINS; b++){
+        cum += T.hist[phase * TIMER_BINS + b];
+        if (cum >= target){
+            bin = b;
+            break;
+        }
+    }
+    double sec = pow(2, (bin + 0.5) / TIMER_BINS_PER_OCTAVE) * 1e-9;
+    return fmin(sec, T.max[phase]);
+}
+
+
+const char *PhaseName(int phase)
+{
+    const char *names[PH_N] = {"split_dead", "sort", "pred_create", "neighbors",
+                               "forces", "pred_detect", "update", "pred_move",
+                               "pred_kill", "out_swarm", "out_fishnet",
+                               "out_part", "out_pred"};
+    return names[phase];
+}
+
+
+static std::vector<double> PhaseStats(const phase_timers &T, int phase)
+{
+    // {calls, total, mean, p50, p90, p99, max, allocs, foreign}
+    double n = T.calls[phase];
+    std::vector<double> out {n, T.total[phase], (n > 0) ? T.total[phase] / n : 0,
+                             PhasePercentile(T, phase, 0.5),
+                             PhasePercentile(T, phase, 0.9),
+                             PhasePercentile(T, phase, 0.99), T.max[phase],
+                             static_cast<double>(T.allocs[phase]),
+                             static_cast<double>(T.foreign[phase])};
+    return out;
+}
+
+
+void PrintPhaseTimers(const phase_timers &T)
+{
+    if (!T.on)
+        return;
+    double run = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                               - T.start).count();
+    double timed = 0;
+    printf("\ntime per phase (run: %.3fs)\n", run);
+    printf("%-12s %10s %10s %6s %10s %10s %10s %10s %10s %10s %10s\n", "phase",
+           "calls", "total[s]", "%run", "mean[us]", "p50[us]", "p90[us]",
+           "p99[us]", "max[us]", "allocs", "foreign");
+    for (int k=0; k<PH_N; k++){
+        if (T.calls[k] == 0)
+            continue;
+        std::vector<double> s = PhaseStats(T, k);
+        timed += s[1];
+        printf("%-12s %10.0f %10.4f %6.1f %10.2f %10.2f %10.2f %10.2f %10.2f %10.0f %10.0f\n",
+               PhaseName(k), s[0], s[1], 100 * s[1] / run, 1e6 * s[2],
+               1e6 * s[3], 1e6 * s[4], 1e6 * s[5], 1e6 * s[6], s[7], s[8]);
+    }
+    printf("%-12s %10s %10.4f %6.1f\n", "untimed", "", run - timed,
+           100 * (run - timed) / run);
+    if (!T.hw_on)
+        return;
+    // per 1000 instructions, cpu: cpu time / wall time
+    printf("\ncounters per phase (main thread)\n");
+    printf("%-12s %8s %14s %14s %8s\n", "phase", "IPC", "cache_miss/ki",
+           "branch_miss/ki", "cpu");
+    for (int k=0; k<PH_N; k++){
+        if (T.calls[k] == 0)
+            continue;
+        const double *c = &T.hw[k * HW_N];
+        printf("%-12s %8.2f %14.2f %14.2f %8.2f\n", PhaseName(k),
+               c[HW_INSTRUCTIONS] / c[HW_CYCLES],
+               1000 * c[HW_CACHE_MISSES] / c[HW_INSTRUCTIONS],
+               1000 * c[HW_BRANCH_MISSES] / c[HW_INSTRUCTIONS],
+               1e-9 * c[HW_TASK_CLOCK] / T.total[k]);
+    }
+}
+
+
+static void h5WritePhase(H5::H5File *H5out, std::string n_dset,
+                         std::vector<double> data)
+{
+    // repeated runs into the same file: last run is kept
+    if (H5Lexists(H5out->getId(), n_dset.c_str(), H5P_DEFAULT) > 0)
+        H5out->unlink(n_dset.c_str());
+    std::vector<hsize_t> dim {1, data.size()};
+    std::vector<hsize_t> offset {0, 0};
+    H5::DataSet dset = h5CreateDSet(H5out, dim, n_dset, "double");
+    h5WriteDouble(&dset, data, offset);
+}
+
+
+void WritePhaseTimers(const phase_timers &T, std::string location,
+                      std::string fileID, int out_h5)
+{
+    if (!T.on)
+        return;
+    if (out_h5){
+        std::string f_h5out = location + "out_" + fileID + ".h5";
+        H5::H5File *H5out;
+        if ( exists(f_h5out) )
+            H5out = new H5::H5File(f_h5out.c_str(), H5F_ACC_RDWR);
+        else
+            H5out = new H5::H5File(f_h5out.c_str(), H5F_ACC_TRUNC);
+        std::string group = "/timing";
+        if (fileID != "xx"){
+            if (H5Lexists(H5out->getId(), ("/" + fileID).c_str(), H5P_DEFAULT) <= 0)
+                H5out->createGroup(("/" + fileID).c_str());
+            group = "/" + fileID + group;
+        }
+        if (H5Lexists(H5out->getId(), group.c_str(), H5P_DEFAULT) <= 0)
+            H5out->createGroup(group.c_str());
+        for (int k=0; k<PH_N; k++)
+            h5WritePhase(H5out, group + "/" + PhaseName(k), PhaseStats(T, k));
+        if (T.hw_on){
+            group += "/counters";
+            if (H5Lexists(H5out->getId(), group.c_str(), H5P_DEFAULT) <= 0)
+                H5out->createGroup(group.c_str());
+            for (int k=0; k<PH_N; k++)
+                h5WritePhase(H5out, group + "/" + PhaseName(k),
+                             std::vector<double>(&T.hw[k * HW_N], &T.hw[(k + 1) * HW_N]));
+        }
+        delete H5out;
+    }
+    else{
+        std::ofstream outFile((location + "timing_" + fileID + ".dat").c_str());
+        outFile << "# phase calls total mean p50 p90 p99 max (seconds) allocs foreign";
+        for (int j=0; T.hw_on && j<HW_N; j++)
+            outFile << " " << CounterName(j);
+        outFile << std::endl;
+        for (int k=0; k<PH_N; k++){
+            std::vector<double> s = PhaseStats(T, k);
+            outFile << PhaseName(k);
+            for (unsigned int j=0; j<s.size(); j++)
+                outFile << " " << s[j];
+            for (int j=0; T.hw_on && j<HW_N; j++)
+                outFile << " " << T.hw[k * HW_N + j];
+            outFile << std::endl;
+        }
+    }
+}
@@ -0,0 +1,188 @@
+/*  PhaseTimers
+    runtime-switchable timers of the phases of a step
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef phase_timers_H
+#define phase_timers_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+
+// phases with their own timer
+enum timer_phase{
+    PH_SPLIT_DEAD,      // split_dead
+    PH_SORT,            // SpatialSort (sort_every)
+    PH_PRED_CREATE,     // predator / fishnet creation
+    PH_NEIGHBORS,       // triangulation (voronoi) or kd-tree (topological)
+    PH_FORCES,          // traversal of the neighbors (social forces)
+    PH_PRED_DETECT,     // prey detecting predators
+    PH_UPDATE,          // agent update (ParticleBurstCoast)
+    PH_PRED_MOVE,       // predator / fishnet movement
+    PH_PRED_KILL,       // predator kills
+    PH_OUT_SWARM,       // Out_swarm + write
+    PH_OUT_FISHNET,     // Out_swarm_fishNet + write
+    PH_OUT_PART,        // WriteParticles of prey
+    PH_OUT_PRED,        // WriteParticles of predators
+    PH_N
+};
+
+// Switched on at runtime (params.timing), off a scope costs 1 branch.
+// Durations are histogrammed on a log scale (TIMER_BINS_PER_OCTAVE bins
+// per factor 2 starting at 1ns) -> percentiles with ~9% resolution in
+// constant memory.
+#define TIMER_BINS_PER_OCTAVE 8
+#define TIMER_OCTAVES 40
+#define TIMER_BINS (TIMER_BINS_PER_OCTAVE * TIMER_OCTAVES)
+// Trace (params.trace_every > 0): every phase of every trace_every-th step
+// (and output) is written as chrome trace event to trace_fileID.json
+// (chrome://tracing or ui.perfetto.dev), worker threads with their own tid.
+// Hardware counters (params.timing = 2, Linux perf_event_open, user space
+// of the main thread only): counts per phase. Counters which can not be
+// opened (no PMU in VMs/containers, perf_event_paranoid) are reported as
+// nan, the timers work anyway.
+// Heap allocations per phase (alloc_counter.h): own and foreign (CGAL),
+// counted with the timers, worker threads included.
+enum hw_counter{
+    HW_CYCLES,
+    HW_INSTRUCTIONS,
+    HW_CACHE_MISSES,
+    HW_BRANCH_MISSES,
+    HW_TASK_CLOCK,      // cpu time in ns (software counter)
+    HW_N
+};
+struct trace_event{
+    const char *name;
+    double ts, dur;     // microseconds since start of the run
+    int tid;
+    int step;
+};
+struct phase_timers{
+    bool on;
+    std::vector<unsigned long long> calls;
+    std::vector<double> total;              // seconds
+    std::vector<double> max;
+    std::vector<unsigned long long> hist;   // PH_N x TIMER_BINS
+    std::chrono::steady_clock::time_point start;    // of the run
+    unsigned int trace_every;
+    bool trace;                             // current step is traced
+    int step;
+    FILE *trace_file;
+    std::vector<trace_event> events;        // not yet written
+    bool hw_on;                             // at least 1 counter open
+    int hw_fd[HW_N];                        // -1: not available
+    std::vector<double> hw;                 // PH_N x HW_N
+    std::vector<unsigned long long> allocs; // own heap allocations
+    std::vector<unsigned long long> foreign;    // CGAL internals
+};
+typedef struct phase_timers phase_timers;
+
+void InitPhaseTimers(phase_timers &T, bool on);
+void AddPhaseTime(phase_timers &T, int phase, double sec);
+void InitPhaseTrace(phase_timers &T, unsigned int trace_every, std::string fname);
+// traced if count (step or output step) is a multiple of trace_every
+void TraceSample(phase_timers &T, int step, unsigned int count);
+// thread safe (omp critical)
+void AddTraceEvent(phase_timers &T, const char *name,
+                   std::chrono::steady_clock::time_point t0,
+                   std::chrono::steady_clock::time_point t1, int tid);
+void FlushTrace(phase_timers &T);
+void CloseTrace(phase_timers &T);
+void InitPhaseCounters(phase_timers &T);
+void ReadPhaseCounters(const phase_timers &T, long long c[HW_N]);
+void ClosePhaseCounters(phase_timers &T);
+const char *CounterName(int counter);
+// peak resident memory of the process in MB (0: unknown, linux only)
+double PeakRSS();
+double PhasePercentile(const phase_timers &T, int phase, double q);
+const char *PhaseName(int phase);
+void PrintPhaseTimers(const phase_timers &T);
+// h5: group "timing" with 1 dataset per phase
+//     {calls, total, mean, p50, p90, p99, max (seconds), allocs, foreign}
+//     (counters: group "timing/counters", 1 dataset per phase with HW_N counts)
+// txt: the same as table in timing_fileID.dat (counters as extra columns)
+void WritePhaseTimers(const phase_timers &T, std::string location,
+                      std::string fileID, int out_h5);
+
+// times its scope (timer and trace)
+struct phase_scope{
+    phase_timers &T;
+    int phase;
+    std::chrono::steady_clock::time_point t0;
+    long long c0[HW_N];
+    alloc_stats a0;
+    phase_scope(phase_timers &T, int phase) : T(T), phase(phase)
+    {
+        if (T.on || T.trace)
+            t0 = std::chrono::steady_clock::now();
+        if (T.on)
+            a0 = AllocStats();
+        if (T.hw_on)
+            ReadPhaseCounters(T, c0);
+    }
+    ~phase_scope()
+    {
+        stop();
+    }
+    // ends the measurement before the end of the scope
+    void stop()
+    {
+        if (T.hw_on && phase >= 0){
+            long long c1[HW_N];
+            ReadPhaseCounters(T, c1);
+            for (int k=0; k<HW_N; k++)
+                T.hw[phase * HW_N + k] += c1[k] - c0[k];
+        }
+        if (T.on && phase >= 0){
+            alloc_stats a1 = AllocStats();
+            T.allocs[phase] += a1.allocs - a0.allocs;
+            T.foreign[phase] += a1.foreign - a0.foreign;
+        }
+        if ((T.on || T.trace) && phase >= 0){
+            std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+            if (T.on)
+                AddPhaseTime(T, phase, std::chrono::duration<double>(t1 - t0).count());
+            if (T.trace)
+                AddTraceEvent(T, PhaseName(phase), t0, t1, 0);
+        }
+        phase = -1;
+    }
+};
+
+// traces its scope only (sub-phases, worker thread tid)
+struct trace_scope{
+    phase_timers &T;
+    const char *name;
+    int tid;
+    std::chrono::steady_clock::time_point t0;
+    trace_scope(phase_timers &T, const char *name, int tid=0) : T(T), name(name), tid(tid)
+    {
+        if (T.trace)
+            t0 = std::chrono::steady_clock::now();
+    }
+    ~trace_scope()
+    {
+        if (T.trace)
+            AddTraceEvent(T, name, t0, std::chrono::steady_clock::now(), tid);
+    }
+};
+#endif
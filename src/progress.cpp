@@ -0,0 +1,123 @@
+/*  Progress
+    periodic progress and throughput report of a run (params.progress)
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "progress.h"
+
+#include <cstdio>
+#include <ctime>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+
+void InitProgress(progress &P, double every, std::string location,
+                  std::string fileID, int steps, double dt, unsigned int Nrep)
+{
+    P.every = every;
+    P.location = location;
+    P.fileID = fileID;
+    P.fname = location + "progress_" + fileID + ".dat";
+    P.Nrep = Nrep;
+    P.steps = steps;
+    P.dt = dt;
+    P.start = std::chrono::steady_clock::now();
+    P.last = P.start;
+    P.last_step = 0;
+}
+
+
+// bytes of the output files of the run (name ends with "_" + fileID + ".ext",
+// fileID 1 does not match the files of 11 or 100)
+static unsigned long long OutputBytes(const progress &P)
+{
+    unsigned long long bytes = 0;
+    std::string dir = (P.location == "") ? "." : P.location;
+    DIR *d = opendir(dir.c_str());
+    if (d == NULL)
+        return 0;
+    std::string tag = "_" + P.fileID + ".";
+    std::string own = "progress" + tag;
+    struct dirent *e;
+    struct stat st;
+    while ((e = readdir(d)) != NULL){
+        std::string name = e->d_name;
+        size_t pos = name.rfind(tag);
+        if (pos == std::string::npos || name.find('.', pos + tag.size()) != std::string::npos ||
+            name.find(own) == 0)
+            continue;
+        if (stat((dir + "/" + name).c_str(), &st) == 0 && S_ISREG(st.st_mode))
+            bytes += st.st_size;
+    }
+    closedir(d);
+    return bytes;
+}
+
+
+void WriteProgress(progress &P, int s, unsigned int alive, unsigned int dead,
+                   bool done)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double wall = std::chrono::duration<double>(now - P.start).count();
+    double dwall = std::chrono::duration<double>(now - P.last).count();
+    double rate = (dwall > 0) ? (s - P.last_step) / dwall : 0;  // steps/s (recent)
+    double mean_rate = (wall > 0) ? s / wall : 0;
+    double t = s * P.dt;
+    double eta = (rate > 0) ? (P.steps - s) / rate : -1;
+    if (done){
+        rate = mean_rate;
+        eta = 0;
+    }
+    unsigned long long bytes = OutputBytes(P);
+    fprintf(stderr, "progress: t %g / %g s (%.1f%%) %.4g steps/s rtf %.4g alive %u "
+            "dead %u out %.4g MB wall %.1f s eta %.1f s%s\n",
+            t, P.steps * P.dt, 100. * s / P.steps, rate, rate * P.dt, alive,
+            dead, bytes / 1048576., wall, eta, done ? " (done)" : "");
+    // replace the status file at once (readers never see a partial file)
+    std::string tmp = P.fname + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "w");
+    if (fp != NULL){
+        char host[256] = "unknown";
+        gethostname(host, sizeof(host) - 1);
+        fprintf(fp, "fileID:             \t%s\n", P.fileID.c_str());
+        fprintf(fp, "host:               \t%s\n", host);
+        fprintf(fp, "pid:                \t%d\n", static_cast<int>(getpid()));
+        fprintf(fp, "state:              \t%s\n", done ? "done" : "running");
+        fprintf(fp, "updated:            \t%ld\n", static_cast<long>(time(NULL)));
+        fprintf(fp, "every:              \t%g\n", P.every);
+        fprintf(fp, "step:               \t%d\n", s);
+        fprintf(fp, "steps:              \t%d\n", P.steps);
+        fprintf(fp, "sim_time:           \t%g\n", t);
+        fprintf(fp, "time:               \t%g\n", P.steps * P.dt);
+        fprintf(fp, "wall:               \t%g\n", wall);
+        fprintf(fp, "steps_per_s:        \t%g\n", rate);
+        fprintf(fp, "mean_steps_per_s:   \t%g\n", mean_rate);
+        fprintf(fp, "rtf:                \t%g\n", rate * P.dt);
+        fprintf(fp, "Nrep:               \t%u\n", P.Nrep);
+        fprintf(fp, "alive:              \t%u\n", alive);
+        fprintf(fp, "dead:               \t%u\n", dead);
+        fprintf(fp, "output_bytes:       \t%llu\n", bytes);
+        fprintf(fp, "eta:                \t%g\n", eta);
+        fclose(fp);
+        rename(tmp.c_str(), P.fname.c_str());
+    }
+    P.last = now;
+    P.last_step = s;
+}
@@ -0,0 +1,60 @@
+/*  Progress
+    periodic progress and throughput report of a run (params.progress)
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef progress_H
+#define progress_H
+
+#include <chrono>
+#include <string>
+
+// Every "every" seconds of wall time one line goes to stderr and the
+// status file (location + "progress_" + fileID + ".dat", "key: value" per
+// line, replaced atomically) is rewritten: step, simulated time, step rate
+// (since the last report and mean), real-time factor, alive and dead agents,
+// output bytes (files of the run in location), ETA, state (running/done).
+// WatchRuns.py polls the status files of several runs (workers of a sweep).
+struct progress{
+    double every;           // seconds of wall time between reports (0: off)
+    std::string fname;      // status file
+    std::string location, fileID;
+    unsigned int Nrep;      // replicates (ensemble mode)
+    int steps;              // total # of steps
+    double dt;
+    std::chrono::steady_clock::time_point start, last;
+    int last_step;
+};
+typedef struct progress progress;
+
+void InitProgress(progress &P, double every, std::string location,
+                  std::string fileID, int steps, double dt, unsigned int Nrep=1);
+// report of step s with alive / dead agents (all replicates)
+void WriteProgress(progress &P, int s, unsigned int alive, unsigned int dead,
+                   bool done);
+// reports if "every" seconds passed since the last report
+inline void ReportProgress(progress &P, int s, unsigned int alive, unsigned int dead)
+{
+    if (P.every <= 0)
+        return;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - P.last).count() >= P.every)
+        WriteProgress(P, s, alive, dead, false);
+}
+#endif
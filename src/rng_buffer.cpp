@@ -0,0 +1,92 @@
+/*  RNGBuffer
+    per-step random number service: uniforms are generated in blocks
+    and handed out to the subsystems of SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "rng_buffer.h"
+
+#include <cstdio>
+
+
+static uint64_t SplitMix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+void InitRNGBuffer(rngbuffer &R, gsl_rng *r, unsigned int size)
+{
+    // block size is a multiple of the lanes
+    size = RNG_LANES * ((size + RNG_LANES - 1) / RNG_LANES);
+    uint64_t x = gsl_rng_get(r);
+    x = (x << 32) ^ gsl_rng_get(r);
+    for (unsigned int l=0; l<RNG_LANES; l++){
+        R.s0[l] = SplitMix64(x);
+        R.s1[l] = SplitMix64(x);
+        R.s2[l] = SplitMix64(x);
+        R.s3[l] = SplitMix64(x);
+    }
+    R.u.assign(size, 0);
+    R.pos = size;   // filled at first draw
+    R.has_normal = false;
+    R.normal = 0;
+    for (unsigned int k=0; k<RNG_NSUB; k++)
+        R.count[k] = 0;
+    R.blocks = 0;
+}
+
+
+void FillRNGBuffer(rngbuffer &R)
+{
+    // xoshiro256+ (Blackman & Vigna), upper 53 bits -> double in [0, 1)
+    unsigned int n = R.u.size();
+    double *u = &R.u[0];
+    uint64_t *s0 = R.s0;
+    uint64_t *s1 = R.s1;
+    uint64_t *s2 = R.s2;
+    uint64_t *s3 = R.s3;
+    for (unsigned int b=0; b<n; b+=RNG_LANES){
+        for (unsigned int l=0; l<RNG_LANES; l++){
+            uint64_t result = s0[l] + s3[l];
+            uint64_t t = s1[l] << 17;
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = (s3[l] << 45) | (s3[l] >> 19);
+            u[b + l] = static_cast<double>(result >> 11) * (1.0 / 9007199254740992.0);
+        }
+    }
+    R.pos = 0;
+    R.blocks++;
+}
+
+
+void PrintRNGUsage(rngbuffer &R)
+{
+    const char *names[RNG_NSUB] = {"burst", "interval", "detect", "pred", "kill"};
+    printf("\nrandom numbers per subsystem:");
+    for (unsigned int k=0; k<RNG_NSUB; k++)
+        printf(" %s=%llu", names[k], R.count[k]);
+    printf(" (blocks=%llu)\n", R.blocks);
+}
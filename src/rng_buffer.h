@@ -0,0 +1,92 @@
+/*  RNGBuffer
+    per-step random number service: uniforms are generated in blocks
+    and handed out to the subsystems of SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef rng_buffer_H
+#define rng_buffer_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <gsl/gsl_rng.h>
+
+// subsystems for the accounting of draws
+enum rng_subsystem{
+    RNG_BURST,      // social vs. environmental cue and its direction
+    RNG_INTERVAL,   // steps till next burst
+    RNG_DETECT,     // predator detection by prey
+    RNG_PRED,       // predator movement
+    RNG_KILL,       // predator kills
+    RNG_NSUB
+};
+
+// The block is filled by xoshiro256+ generators running in RNG_LANES
+// interleaved lanes (state as structure of arrays), thus the update of the
+// states is vectorized by the compiler. The lanes are seeded from the gsl
+// generator -> runs are reproducible for a given seed.
+#define RNG_LANES 8
+struct rngbuffer{
+    uint64_t s0[RNG_LANES], s1[RNG_LANES], s2[RNG_LANES], s3[RNG_LANES];
+    std::vector<double> u;      // uniforms in [0, 1)
+    unsigned int pos;           // next unused uniform
+    bool has_normal;            // second normal of Box-Muller
+    double normal;
+    unsigned long long count[RNG_NSUB];
+    unsigned long long blocks;  // # of refilled blocks
+};
+typedef struct rngbuffer rngbuffer;
+
+void InitRNGBuffer(rngbuffer &R, gsl_rng *r, unsigned int size);
+void FillRNGBuffer(rngbuffer &R);
+void PrintRNGUsage(rngbuffer &R);
+
+inline double RandUniform(rngbuffer &R, int sys)
+{
+    if (R.pos == R.u.size())
+        FillRNGBuffer(R);
+    R.count[sys]++;
+    return R.u[R.pos++];
+}
+
+// standard normal (Box-Muller, 2 uniforms per 2 normals)
+inline double RandNormal(rngbuffer &R, int sys)
+{
+    if (R.has_normal){
+        R.has_normal = false;
+        return R.normal;
+    }
+    double rad = sqrt(-2 * log(1 - RandUniform(R, sys)));
+    double ang = 2 * M_PI * RandUniform(R, sys);
+    R.normal = rad * sin(ang);
+    R.has_normal = true;
+    return rad * cos(ang);
+}
+
+// # of failures before the first success with success probability q
+// (inversion, 1 uniform; = gsl_ran_geometric - 1)
+inline unsigned int RandFailures(rngbuffer &R, double q, int sys)
+{
+    double u = RandUniform(R, sys);
+    if (q >= 1)
+        return 0;
+    double k = floor(log1p(-u) / log1p(-q));
+    return (k < 4e9) ? static_cast<unsigned int>(k) : 4000000000u;
+}
+#endif
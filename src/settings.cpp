@@ -25,6 +25,7 @@ void SetCoreParameters(params* SP)
     // Function setting core system parameters to prevent crashes
     SP->sizeL=100.;
     SP->N=100;
+    SP->Nrep=1;
     SP->sim_time=100;
     SP->dt=0.05;
     SP->noisep=0.01;
@@ -36,10 +37,18 @@ void SetCoreParameters(params* SP)
     SP->rep_range=1.0;
     SP->att_range=0.0;
     SP->alg_range=0.0;
+    SP->kNN=0;
+    SP->engine=0;
+    SP->sfm=0;
+    SP->sort_every=0;
+    SP->vor_threads=0;
 
     SP->soc_strength=50;
     SP->env_strength=60;
     SP->burst_rate=3;
+    SP->burst_dist=0;
+    SP->burst_shape=1;
+    SP->burst_file="none";
 
     SP->alphaTurn=-0.2;
 
@@ -51,6 +60,8 @@ void SetCoreParameters(params* SP)
 
     SP->output=1.0;
     SP->BC=-1;
+    SP->arena_file="none";
+    SP->arena_res=0.1;
     SP->IC=0;
     SP->N_confu=3;
     SP->pred_kill=0;
@@ -69,6 +80,13 @@ void SetCoreParameters(params* SP)
     SP->location = "./";
     SP->fileID = "xx";
     SP->out_h5 = 1;
+    SP->timing = 0;
+    SP->trace_every = 0;
+    InitPhaseTimers(SP->timers, false);
+    SP->alloc_check = 0;
+    SP->seed = 0;
+    SP->progress = 0;
+    SP->scratch.vor = NULL;
     SP->outstep = 0;
     SP->outstep_pred = 0;
 
@@ -106,6 +124,17 @@ void InitSystemParameters(params* SP)
 
     SP->burst_steps = (int) (SP->burst_duration/SP->dt);
 
+    InitBurstSampler(SP->bursts, SP->burst_dist, SP->burst_rate, SP->dt,
+                     SP->burst_shape, SP->location + SP->burst_file);
+    SP->burst_dist = SP->bursts.dist;
+
+    // exact propagators up to the maximum inter-burst interval (DrawStepsTillBurst)
+    unsigned int kmax = SP->burst_steps + SP->bursts.kmax;
+    InitPropagator(SP->prop, SP->beta, SP->dt, SP->burst_steps, kmax);
+
+    if (SP->arena_res <= 0)
+        SP->arena_res = 0.1;
+
     // if BC not periodic -> set systemsize laarge
     if (SP->BC < 0)
         SP->sizeL =  SP->N * SP->N;
@@ -142,6 +171,9 @@ void InitSystemParameters(params* SP)
         SP->out_mean = false;
         SP->out_particle = false;
     }
+
+    // buffers of the step (freed at the end of main)
+    SP->scratch.vor = NewVoronoiScratch();
 }
 
 void InitPredator(std::vector<predator> &preds){
@@ -189,6 +221,8 @@ void InitSystem(std::vector<particle> &a, params SP)
         a[i].bin_step = 0;
         a[i].steps_till_burst = 0;
         a[i].id = i;
+        // interaction partners of a step: no reallocation in the steady state
+        a[i].NN.reserve(std::max(64u, SP.kNN));
     }
 
 }
@@ -268,6 +302,8 @@ void ResetSystem(std::vector<particle> &a, params *ptrSP, bool out, gsl_rng *r)
         std::vector<int> allprey(N);
         std::iota (std::begin(allprey), std::end(allprey), 0); //Fill with 0, 1,...N
         unsigned seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        if (ptrSP->seed > 0)
+            seed = ptrSP->seed;
         std::shuffle(allprey.begin(), allprey.end(), std::default_random_engine(seed));
         for(i=0; i<N; i++)
         {
@@ -381,6 +417,9 @@ void ResetSystem(std::vector<particle> &a, params *ptrSP, bool out, gsl_rng *r)
         std::string fname = "init_coord.dat";
         WritePosVel(a, ptrSP, fname);
     }
+    // arena: agents start in free space at least 1 BL away from the wall
+    if (ptrSP->BC == BCArena::id && BCArena::field != NULL)
+        ArenaPlaceInside(*BCArena::field, a, 1, r);
     if( ptrSP->BC != -1 )
         for(i=0; i<N; i++)
             Boundary(a[i], ptrSP->sizeL, ptrSP->BC);
@@ -22,31 +22,58 @@
 #include "social_forces.h"
 
 // Social-Force-Models------------------------------------------------
-void SFM_4Zone(params *ptrSP, double u_ji[2],
-               double dist_interaction, double v_ji[2],
-               unsigned int c[3], double f0[2],
-               double f1[2], double f2[2]){
-    /* computes the 4 forces assuming input of c = {0, 0, 0, 0}
-     * and fx = {0, 0}
-     */
-    // FORCE0 (repulsion)
-    if(dist_interaction <= ptrSP->rep_range){
-        c[0]++;
-        f0[0] = u_ji[0];
-        f0[1] = u_ji[1];
-    }
-    // FORCE1 (alignment)
-    else if((dist_interaction > ptrSP->rep_range) && 
-            (dist_interaction <= ptrSP->alg_range)){
-        c[1]++;
-        f1[0] = v_ji[0];
-        f1[1] = v_ji[1];
-    }
-    // FORCE2 (attraction)
-    else if((dist_interaction > ptrSP->alg_range) &&
-            (dist_interaction <= ptrSP->att_range)){
-        c[2]++;
-        f2[0] = u_ji[0];
-        f2[1] = u_ji[1];
+template<class SFM>
+void SFMBatch(params *ptrSP, unsigned int n,
+              const double *u0, const double *u1,
+              const double *v0, const double *v1,
+              const double *dist, const double *edge,
+              double f0[2], double f1[2], double f2[2],
+              unsigned int c[3], double *used)
+{
+    // branch-free loop over neighbors (SIMD-friendly: no early exits)
+    double s[6] = {0, 0, 0, 0, 0, 0};
+    double cnt[3] = {0, 0, 0};
+    for (unsigned int j=0; j<n; j++){
+        double w[3];
+        SFM::Weights(ptrSP, dist[j], edge[j], w);
+        s[0] += w[0] * u0[j];
+        s[1] += w[0] * u1[j];
+        s[2] += w[1] * v0[j];
+        s[3] += w[1] * v1[j];
+        s[4] += w[2] * u0[j];
+        s[5] += w[2] * u1[j];
+        cnt[0] += (w[0] > 0) ? 1 : 0;
+        cnt[1] += (w[1] > 0) ? 1 : 0;
+        cnt[2] += (w[2] > 0) ? 1 : 0;
+        used[j] = (w[0] + w[1] + w[2] > 0) ? 1 : 0;
     }
+    f0[0] = s[0];
+    f0[1] = s[1];
+    f1[0] = s[2];
+    f1[1] = s[3];
+    f2[0] = s[4];
+    f2[1] = s[5];
+    for (unsigned int k=0; k<3; k++)
+        c[k] = static_cast<unsigned int>(cnt[k]);
 }
+template
+void SFMBatch<SFM4Zone>(params *ptrSP, unsigned int n,
+                        const double *u0, const double *u1,
+                        const double *v0, const double *v1,
+                        const double *dist, const double *edge,
+                        double f0[2], double f1[2], double f2[2],
+                        unsigned int c[3], double *used);
+template
+void SFMBatch<SFMSmooth>(params *ptrSP, unsigned int n,
+                         const double *u0, const double *u1,
+                         const double *v0, const double *v1,
+                         const double *dist, const double *edge,
+                         double f0[2], double f1[2], double f2[2],
+                         unsigned int c[3], double *used);
+template
+void SFMBatch<SFMVoronoiEdge>(params *ptrSP, unsigned int n,
+                              const double *u0, const double *u1,
+                              const double *v0, const double *v1,
+                              const double *dist, const double *edge,
+                              double f0[2], double f1[2], double f2[2],
+                              unsigned int c[3], double *used);
@@ -24,9 +24,78 @@
 #include "mathtools.h"
 #include "agents.h"
 
+#include <cmath>
+
 // Social-Force-Models------------------------------------------------
-void SFM_4Zone(params *ptrSP, double u_ji[2],
-               double dist_interaction, double v_ji[2],
-               unsigned int c[3], double f0[2],
-               double f1[2], double f2[2]);
+// Every model is a policy (template parameter of the interaction engine)
+// with the branch-free zone weights w = {repulsion, alignment, attraction}
+// of a neighbor at distance "dist" sharing a voronoi edge of length "edge"
+// (edge = inf if unbounded or unknown):
+//      static void Weights(params *, double dist, double edge, double w[3])
+//      static const bool uses_edge;    // if voronoi edges must be computed
+// Selected at runtime by params.sfm (see SelectStep in swarmdyn.cpp)
+
+// 4 zones (couzin-like): weight 1 in the zone of the neighbor, 0 else
+struct SFM4Zone{
+    static const bool uses_edge = false;
+    static inline void Weights(params *ptrSP, double dist, double edge, double w[3])
+    {
+        double rep = ptrSP->rep_range;
+        double alg = ptrSP->alg_range;
+        double att = ptrSP->att_range;
+        w[0] = (dist <= rep) ? 1 : 0;
+        w[1] = (dist > rep && dist <= alg) ? 1 : 0;
+        w[2] = (dist > alg && dist <= att) ? 1 : 0;
+    }
+};
+
+// smooth transition from 0 to 1 around r (cubic on [0.9 r, 1.1 r])
+inline double SmoothStep(double dist, double r)
+{
+    double delta = 0.1 * r;
+    double x = (delta > 0) ? (dist - r + delta) / (2 * delta) : ((dist > r) ? 1 : 0);
+    x = fmin(fmax(x, 0.), 1.);
+    return x * x * (3 - 2 * x);
+}
+
+// smooth zones: the 4-zone weights blended at the zone borders
+// (weights sum to 1 inside att_range and vanish beyond 1.1 * att_range)
+struct SFMSmooth{
+    static const bool uses_edge = false;
+    static inline void Weights(params *ptrSP, double dist, double edge, double w[3])
+    {
+        double s_rep = SmoothStep(dist, ptrSP->rep_range);
+        double s_alg = SmoothStep(dist, ptrSP->alg_range);
+        double s_att = SmoothStep(dist, ptrSP->att_range);
+        w[0] = 1 - s_rep;
+        w[1] = s_rep * (1 - s_alg);
+        w[2] = s_alg * (1 - s_att);
+    }
+};
+
+// voronoi-edge weighted: 4-zone weights scaled by edge / (edge + dist),
+// i.e. neighbors sharing a long voronoi edge (relative to their distance)
+// dominate, neighbors with an unbounded cell (edge = inf) have weight 1
+struct SFMVoronoiEdge{
+    static const bool uses_edge = true;
+    static inline void Weights(params *ptrSP, double dist, double edge, double w[3])
+    {
+        SFM4Zone::Weights(ptrSP, dist, edge, w);
+        double scale = std::isinf(edge) ? 1 : edge / (edge + dist);
+        w[0] *= scale;
+        w[1] *= scale;
+        w[2] *= scale;
+    }
+};
+
+// batch entry point: summed forces of n neighbors of one focal agent
+// (structure of arrays: u = unit vector focal->neighbor, v = neighbor velocity)
+// c[k] = # of neighbors with w[k] > 0, used[j] = 1 if neighbor j contributes
+template<class SFM>
+void SFMBatch(params *ptrSP, unsigned int n,
+              const double *u0, const double *u1,
+              const double *v0, const double *v1,
+              const double *dist, const double *edge,
+              double f0[2], double f1[2], double f2[2],
+              unsigned int c[3], double *used);
 #endif
@@ -30,6 +30,8 @@ gsl_rng *r; // global generator
 const gsl_rng_type * T;
 
 //Runs with ./swarmdyn
+// (compiled w/o main with -DSWARMDYN_NO_MAIN for the benchmark, see Makefile)
+#ifndef SWARMDYN_NO_MAIN
 int main(int argc, char **argv)
 {
 
@@ -43,58 +45,139 @@ int main(int argc, char **argv)
     InitSystemParameters(&SysPara);
     OutputParameters(SysPara);
 
+    // arena (BC=7): signed distance field of the tank geometry
+    arena tank;
+    if (SysPara.BC == BCArena::id){
+        if (LoadArena(tank, &SysPara))
+            BCArena::field = &tank;
+        else{
+            std::cout<< "no arena: open boundary used" << std::endl;
+            SysPara.BC = -1;
+        }
+    }
+
     // initialize agents and set initial conditions
     std::vector<particle> agent(SysPara.N);    // particles or prey
     std::vector<particle> agent_dead(0);
     InitSystem(agent, SysPara);
-    InitRNG();
+    InitRNG(SysPara.seed);
     ResetSystem(agent, &SysPara, false, r);
 
     double dt = SysPara.dt;
     SysPara.r = r;
+    InitRNGBuffer(SysPara.rng, r, 4096);
+
+    if (SysPara.Nrep > 1){
+        // unsupported configuration: no output -> failed run
+        bool ok = RunEnsemble(SysPara);
+        FreeBurstSampler(SysPara.bursts);
+        if (!ok)
+            return 1;
+        std::cout<< "\npeak RSS: " << PeakRSS() << " MB" << std::endl;
+        return 0;
+    }
 
+    if (SysPara.engine == -1 && SysPara.kNN == 0)
+        InitEngineModel(SysPara.engines);
+    progress prog;
+    InitProgress(prog, SysPara.progress, SysPara.location, SysPara.fileID,
+                 SysPara.sim_steps, dt);
     std::vector<predator>  preds(SysPara.Npred);
     InitPredator(preds);
+    StepFunction step = SelectStep(SysPara.BC, SysPara.sfm);
 
     int sstart = 0;
-    double t1 = clock(); //,t2 = 0.; // time variables for measuring comp. time
+    InitPhaseTimers(SysPara.timers, SysPara.timing > 0);
+    if (SysPara.timing == 2)
+        InitPhaseCounters(SysPara.timers);
+    InitPhaseTrace(SysPara.timers, SysPara.trace_every,
+                   SysPara.location + "trace_" + SysPara.fileID + ".json");
+    // allocation check: steps after alloc_check warm-up steps and before
+    // the predator (steady state) must not allocate
+    unsigned int alloc_steps = 0;
+    unsigned int alloc_failed = 0;
+    if (SysPara.alloc_check > 0)
+        AllocCounting(true);
     std::cout<< "Go";
     // Perform numerical integrate
-    t1 = clock();
     for(s=sstart; s < SysPara.sim_steps; s++){
+        TraceSample(SysPara.timers, s, s);
         // define some basic time-flags
         bool time_pred = (s >= static_cast<int>(SysPara.pred_time/dt));
         bool time_output = (s >= static_cast<int>(SysPara.trans_time/dt));
         // Perform a single step
         // first split: output handles agents who are dead but
         //  NN of non-dead agents (also imporant for NN2)
-        split_dead(agent, agent_dead, preds);
+        {
+            phase_scope ps(SysPara.timers, PH_SPLIT_DEAD);
+            split_dead(agent, agent_dead, preds);
+        }
         if (agent.size() == 0){
             Output(s, agent, SysPara, preds, true);
             break;
         }
-        Step(s, agent, &SysPara, preds);
+        // engine=-1: cheapest voronoi engine for the current N and spread
+        if (SysPara.engine == -1 && SysPara.kNN == 0 && s % AUTO_EVERY == 0)
+            AutoEngine(agent, &SysPara);
+        // memory order of agents along a Hilbert curve (cache locality)
+        if (SysPara.sort_every > 0 && s % SysPara.sort_every == 0){
+            phase_scope ps(SysPara.timers, PH_SORT);
+            SpatialSort(agent, &SysPara);
+        }
+        {
+            trace_scope ts(SysPara.timers, "step");
+            alloc_stats a0 = AllocStats();
+            step(s, agent, &SysPara, preds);
+            if (SysPara.alloc_check > 0 && s >= SysPara.alloc_check && !time_pred){
+                unsigned long long n = AllocStats().allocs - a0.allocs;
+                if (n > 0 && alloc_failed++ < 10)
+                    std::cout<< "\nstep " << s << ": " << n << " heap allocations";
+                alloc_steps++;
+            }
+        }
         // Data output
         if(s%SysPara.step_output==0 && time_output)
         {
-            // UNCOMMENT if simulation per output step are interesting:
-            // t2= clock();
-            // double tdiff=(t2-t1)/CLOCKS_PER_SEC;
-            // printf("s=%d; time / out. step = %.4f\n",s,tdiff);
-            // t1=t2;
+            TraceSample(SysPara.timers, s, SysPara.outstep);
+            trace_scope ts(SysPara.timers, "output");
             Output(s, agent, SysPara, preds);
             SysPara.outstep += 1;
             if (time_pred)
                 SysPara.outstep_pred += 1;
         }
+        FlushTrace(SysPara.timers);
+        ReportProgress(prog, s + 1, SysPara.N - SysPara.Ndead, SysPara.Ndead);
     }
     // if minimum output generated -> assumes equilibration run
     // -> save final positions velocities
     merge_dead(agent, agent_dead);
     if (SysPara.outstep == 1)
         WritePosVel(agent, &SysPara, "final_posvel_" + SysPara.fileID, false);
+#if PRINT_RNG_USAGE
+    PrintRNGUsage(SysPara.rng);
+#endif
+    PrintPhaseTimers(SysPara.timers);
+    WritePhaseTimers(SysPara.timers, SysPara.location, SysPara.fileID,
+                     SysPara.out_h5);
+    CloseTrace(SysPara.timers);
+    ClosePhaseCounters(SysPara.timers);
+    FreeVoronoiScratch(SysPara.scratch.vor);
+    FreeBurstSampler(SysPara.bursts);
+    // final report after all output is written (complete output_bytes,
+    // "done" only once the run has nothing left to write)
+    if (SysPara.progress > 0)
+        WriteProgress(prog, s, SysPara.N - SysPara.Ndead, SysPara.Ndead, true);
+    std::cout<< "\npeak RSS: " << PeakRSS() << " MB" << std::endl;
+    if (SysPara.alloc_check > 0){
+        std::cout<< "\nalloc check: " << alloc_failed << " of " << alloc_steps
+                 << " steps allocated" << ((alloc_failed > 0) ? " -> FAILED" : " -> ok")
+                 << std::endl;
+        if (alloc_failed > 0)
+            return 1;
+    }
     return 0;
 }
+#endif
 
 
 long unsigned int getseed(int const K)
@@ -123,7 +206,7 @@ long unsigned int getseed(int const K)
 }
 
 
-void InitRNG(){
+void InitRNG(unsigned long fixed_seed){
     // Initialize random number generator
     // time_t  t1;                     // Get system time for random number seed
     // time(&t1);
@@ -131,6 +214,8 @@ void InitRNG(){
     // std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
     // seed=std::chrono::time_cast<long int>(t1);
     seed = static_cast<unsigned long>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    if (fixed_seed > 0)
+        seed = fixed_seed;
 #if PRINT_PARAMS
     printf("Random number seed: %d\n",static_cast<int>(seed));
 #endif
@@ -140,17 +225,106 @@ void InitRNG(){
     gsl_rng_set(r, seed);
 }
 
+bool RunEnsemble(params &SP)
+{
+    // burst-coast scenario only: no predator and no periodic BC
+    // (voronoi-NN are computed without periodic copies)
+    if (SP.Npred > 0 || SP.BC == 0 || SP.BC == BCArena::id || SP.kNN > 0 || SP.engine != 0 || SP.sfm != 0){
+        std::cout<< "ensemble mode (Nrep > 1) only without predator, BC != 0, 7 and voronoi 4-zone interaction" << std::endl;
+        return false;
+    }
+    ensemble ens;
+    InitEnsemble(ens, &SP, seed);
+
+    // one output-array and dataset per replicate
+    std::vector<particle> a(SP.N);
+    InitSystem(a, SP);
+    std::vector< std::vector< std::vector<double> > > dataOut(SP.Nrep);
+    std::vector<double> out;
+
+    progress prog;
+    InitProgress(prog, SP.progress, SP.location, SP.fileID, SP.sim_steps,
+                 SP.dt, SP.Nrep);
+    std::cout<< "Go";
+    for(int s=0; s < SP.sim_steps; s++){
+        bool time_output = (s >= static_cast<int>(SP.trans_time/SP.dt));
+        EnsembleStep(ens, &SP);
+        if(s%SP.step_output==0 && time_output){
+            for (unsigned int r=0; r<SP.Nrep; r++){
+                std::string rep = "_rep" + std::to_string(r);
+                EnsembleGetReplicate(ens, r, a);
+                if (SP.out_mean){
+                    out = Out_swarm(a, SP);
+                    DataCreateSaveWrite(dataOut[r], out, SP, "swarm" + rep);
+                }
+                if (SP.out_particle)
+                    WriteParticles<particle>(a, SP, "part" + rep, SP.outstep);
+            }
+            SP.outstep += 1;
+        }
+        ReportProgress(prog, s + 1, SP.N * SP.Nrep, 0);
+    }
+    if (SP.progress > 0)
+        WriteProgress(prog, SP.sim_steps, SP.N * SP.Nrep, 0, true);
+    FreeEnsemble(ens);
+    return true;
+}
+
+StepFunction SelectStep(int BC, int sfm)
+{
+    switch (BC)
+    {
+        case -1:
+            return SelectStepSFM<BCOpen>(sfm);
+        case 0:
+            return SelectStepSFM<BCPeriodic>(sfm);
+        case 1:
+            return SelectStepSFM<BCInelasticBox>(sfm);
+        case 2:
+            return SelectStepSFM<BCElasticBox>(sfm);
+        case 3:
+            return SelectStepSFM<BCPeriodicXElasticY>(sfm);
+        case 4:
+            return SelectStepSFM<BCPeriodicXInelasticY>(sfm);
+        case 5:
+            return SelectStepSFM<BCElasticCircle>(sfm);
+        case 6:
+            return SelectStepSFM<BCInelasticCircle>(sfm);
+        case 7:
+            return SelectStepSFM<BCArena>(sfm);
+    }
+    std::cout<< "unknown BC=" << BC << ": open boundary used" << std::endl;
+    return SelectStepSFM<BCOpen>(sfm);
+}
+
+template<class BCP>
+StepFunction SelectStepSFM(int sfm)
+{
+    switch (sfm)
+    {
+        case 0:
+            return &Step<BCP, SFM4Zone>;
+        case 1:
+            return &Step<BCP, SFMSmooth>;
+        case 2:
+            return &Step<BCP, SFMVoronoiEdge>;
+    }
+    std::cout<< "unknown sfm=" << sfm << ": 4-zone model used" << std::endl;
+    return &Step<BCP, SFM4Zone>;
+}
+
+template<class BCP, class SFM>
 void Step(int s, std::vector<particle> &a, params* ptrSP, std::vector<predator> &preds)
 {
     // function for performing a single (Euler) integration step
     int i = 0;
-    double rnp = 0.0;
 
     double dt = ptrSP->dt;
     int N = a.size();
 
     // CREATE PREDATOR
     if (s>=ptrSP->pred_time/dt && s-1<ptrSP->pred_time/dt){
+        phase_scope ps(ptrSP->timers, PH_PRED_CREATE);
         if ( preds.size() == 1 )
             CreatePredator(a, ptrSP, preds[0], r);
         else
@@ -165,8 +339,10 @@ void Step(int s, std::vector<particle> &a, params* ptrSP, std::vector<predator>
                                             (ptrSP->pred_speed0 * ptrSP->dt) );
         else
             steps_needed = static_cast<int>( (ptrSP->sim_time - ptrSP->trans_time) / 4 / ptrSP->dt);
-        if ( steps_since_pred % steps_needed == 0 )
+        if ( steps_since_pred % steps_needed == 0 ){
+            phase_scope ps(ptrSP->timers, PH_PRED_CREATE);
             CreateFishNet(a, ptrSP, preds, r);
+        }
     }
     // Reset simulation-step specific values to default
     for (i=0; i<N; i++)
@@ -176,29 +352,38 @@ void Step(int s, std::vector<particle> &a, params* ptrSP, std::vector<predator>
         preds[i].NN.resize(0);
     }
     // INTERACTION:
-    if (s < ptrSP->pred_time/dt)
-        InteractionVoronoiF2F(a, ptrSP);
-    else
-        InteractionVoronoiF2FP(a, ptrSP, preds); // has build in pred->voronoinn computation
+    Interaction<BCP, SFM>(a, ptrSP, preds, s >= ptrSP->pred_time/dt);
 
     // Update all agents
-    for(i=0;i<N;i++)
     {
-        // Generate noise
-        rnp = ptrSP->noisep * gsl_ran_gaussian(r, 1.0);
-        ParticleBurstCoast(a[i], ptrSP, r);
+        phase_scope ps(ptrSP->timers, PH_UPDATE);
+        for(i=0;i<N;i++)
+            ParticleBurstCoast<BCP>(a[i], ptrSP, r);
     }
     // PREDATOR RELATED STUFF(P-move, .... )
     if (s>=ptrSP->pred_time/dt){
         if ( preds.size() > 1 ){
-            MoveFishNet(preds, ptrSP);
-            if ( ptrSP->pred_kill != 0 ) // predator kills if in kill_range (kill_range/sqrt(N_det))
+            {
+                phase_scope ps(ptrSP->timers, PH_PRED_MOVE);
+                MoveFishNet(preds, ptrSP);
+            }
+            if ( ptrSP->pred_kill != 0 ){ // predator kills if in kill_range (kill_range/sqrt(N_det))
+                phase_scope ps(ptrSP->timers, PH_PRED_KILL);
                 FishNetKill(a, preds, ptrSP);
+            }
         }
         else{
-            MovePredator(preds[0], a, ptrSP, r);
-            if ( ptrSP->pred_kill != 0 ) // predator kills if in kill_range (kill_range/sqrt(N_det))
+            {
+                phase_scope ps(ptrSP->timers, PH_PRED_MOVE);
+                // spatial index of prey shared by MovePredator and PredKill
+                if ( ptrSP->pred_move == 1 || ptrSP->pred_kill != 0 )
+                    BuildCellGrid(ptrSP->grid, a, ptrSP);
+                MovePredator(preds[0], a, ptrSP, r);
+            }
+            if ( ptrSP->pred_kill != 0 ){ // predator kills if in kill_range (kill_range/sqrt(N_det))
+                phase_scope ps(ptrSP->timers, PH_PRED_KILL);
                 PredKill(a, preds[0], ptrSP, r);
+            }
         }
     }
 }
@@ -210,24 +395,35 @@ void Output(int s, std::vector<particle> &a, params &SP,
 
     if (s < SP.pred_time / SP.dt){
         if (SP.out_mean){
+            phase_scope ps(SP.timers, PH_OUT_SWARM);
             out = Out_swarm(a, SP);
             DataCreateSaveWrite(SP.dataOutMean, out, SP,
                                 "swarm", forceSave);
         }
-        if (SP.out_particle)
+        if (SP.out_particle){
+            phase_scope ps(SP.timers, PH_OUT_PART);
             WriteParticles<particle>(a, SP, "part", SP.outstep);
+        }
     }
     else{
         if (SP.out_mean){
-            out = Out_swarm(a, SP);
-            DataCreateSaveWrite(SP.dataOutSwarm, out, SP,
-                                "swarm", forceSave);
+            {
+                phase_scope ps(SP.timers, PH_OUT_SWARM);
+                out = Out_swarm(a, SP);
+                DataCreateSaveWrite(SP.dataOutSwarm, out, SP,
+                                    "swarm", forceSave);
+            }
+            phase_scope ps(SP.timers, PH_OUT_FISHNET);
             out = Out_swarm_fishNet(a, preds, SP);
             DataCreateSaveWrite(SP.dataOutSwarmPred, out, SP, 
                                 "swarm_fishNet", forceSave);
         }
         if (SP.out_particle){
-            WriteParticles<particle>(a, SP, "part", SP.outstep);
+            {
+                phase_scope ps(SP.timers, PH_OUT_PART);
+                WriteParticles<particle>(a, SP, "part", SP.outstep);
+            }
+            phase_scope ps(SP.timers, PH_OUT_PRED);
             WriteParticles<predator>(preds, SP, "pred", SP.outstep_pred);
         }
     }
@@ -386,15 +582,14 @@ std::vector<double> Out_swarm_fishNet(std::vector<particle> &a,
         }
     }
     // prey-distance to net (very general)
+    // = distance to closest predator (via spatial index of predators)
     double distMin = SP.sizeL * 2;
-    std::vector<double> hvec(2);
     double distNet = 0;
+    cellgrid predGrid;
+    BuildCellGrid(predGrid, preds, &SP);
     for (int i=0; i<a.size(); i++){
-        for (int j=0; j<preds.size(); j++){
-            hvec = CalcDistVec(preds[j].x, a[i].x, SP.BC, SP.sizeL);
-            dist = vec_length(hvec);
+        if (GridNearest(predGrid, preds, a[i].x, &SP, dist) >= 0)
             distMin = fmin(distMin, dist);
-        }
         distNet += distMin;
         distMin = SP.sizeL * 2; // reset maximum distance
     }
@@ -451,6 +646,7 @@ void DataCreateSaveWrite(std::vector< std::vector<double> > &data,
     data[current] = out;
     // WRITE TO FILE (last output-step)
     if ( (SP.outstep == SP.total_outstep - 1) || forceSave ){
+        trace_scope ts(SP.timers, "write");
         if (SP.out_h5){
             std::string f_h5out = SP.location + "out_" + SP.fileID + ".h5";
             h5CreateWriteDset(f_h5out, SP.fileID, name, data, SP.out_extend);
@@ -549,6 +745,7 @@ void WriteParticles(std::vector<part> &a, params &SP,
     if (a.size() == 0)
         return;
     std::vector<double> out = a[0].out();
+    trace_scope ts(SP.timers, "write");
     if (SP.out_h5){
         H5::DataSet *h5dset;
         // load/create h5-file
@@ -607,19 +804,16 @@ void WriteParticles(std::vector<part> &a, params &SP,
         std::ofstream outFile((SP.location + name + "_" + SP.fileID
                                + ".dat").c_str(), std::ios::app);
         std::vector<double> out_default(out.size(), 0);
-        unsigned int id = 0;
-        for(int i=0; i<a.size(); i++){
-            out = a[i].out();
-            while (id < a[i].id){
-                for (int j=0; j<out_default.size(); j++)
-                    outFile << out_default[j] << " ";
-                outFile << std::endl;
-                id++;
-            }
+        // rows in id order (agents may be spatially sorted, dead are 0)
+        std::vector<int> slot = IdToSlot(a);
+        for(unsigned int id=0; id<slot.size(); id++){
+            if (slot[id] < 0)
+                out = out_default;
+            else
+                out = a[slot[id]].out();
             for (int j=0; j<out.size(); j++)
                 outFile << out[j] << " ";
             outFile << std::endl;
-            id++;
         }
     }
 }
@@ -60,12 +60,24 @@
 #include "h5tools.h"
 // settings: parameters, initialization, reset
 #include "settings.h"
+// lockstep integration of independent replicates
+#include "ensemble.h"
 // input and outputs:
 #include "input_output.h"
+// progress report (stderr + status file)
+#include "progress.h"
 
 // FUNCTION DEFINITION
-void InitRNG();             // initializes the random number generation
+void InitRNG(unsigned long fixed_seed);  // initializes the random number generation (0: seed from the clock)
+template<class BCP, class SFM>
 void Step(int s, std::vector<particle> &a, params *, std::vector<predator> &preds);      // numerical step
+// Step specialized for boundary condition and social force model (selected once at startup)
+typedef void (*StepFunction)(int, std::vector<particle> &, params *, std::vector<predator> &);
+StepFunction SelectStep(int BC, int sfm);
+template<class BCP>
+StepFunction SelectStepSFM(int sfm);
+bool RunEnsemble(params &SP);   // integrates SP.Nrep replicates in lockstep
+                                // (false: unsupported configuration, no run)
 // fctns. for Output:
 void Output(int s, std::vector<particle> &a, params &SP, std::vector<predator> &pred,
             bool forceSave=false);
@@ -0,0 +1,563 @@
+/*  VoronoiTiles
+    domain-decomposed (tiled) voronoi neighbors for large N
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "voronoi_tiles.h"
+#include "alloc_counter.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <omp.h>
+// for CGAL functionality:
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Delaunay_triangulation_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+
+typedef CGAL::Exact_predicates_inexact_constructions_kernel         K;
+typedef CGAL::Triangulation_vertex_base_with_info_2<int, K>         Vb;
+typedef CGAL::Triangulation_data_structure_2<Vb>                    Tds;
+typedef CGAL::Delaunay_triangulation_2<K, Tds>                      Delaunay;
+typedef Delaunay::Face_handle                                       Face_handle;
+typedef Delaunay::Point                                             Point;
+
+struct rect{
+    double x0, y0, x1, y1;
+};
+
+// all points sorted into a uniform grid (~4 points per cell)
+struct bucket_grid{
+    rect box;                           // bounding box of all points
+    double cs;                          // cell size
+    int nx, ny;
+    std::vector<unsigned int> start;    // points of cell c: idx[start[c]] ... idx[start[c+1]-1]
+    std::vector<unsigned int> idx;
+    std::vector<char> dup;              // same position as a point with lower index
+};
+
+// edges found by a tile: owner -> neighbor
+struct tile_edges{
+    std::vector<unsigned int> owner;
+    std::vector<int> nb;
+    std::vector<double> edge;
+    std::vector< std::pair<Point, int> > local;     // points of tile + halo
+};
+
+struct voronoi_scratch{
+    bucket_grid G;
+    std::vector<unsigned int> cell, fill;           // BuildBuckets, MergeEdges
+    std::vector<unsigned int> poly, P, H;           // HullEdges
+    std::vector< std::pair<int, int> > hull;
+    std::vector<int> owner_tile, tiles;
+    std::vector<char> active;
+    std::vector<tile_edges> found;                  // per tile, only grows
+    unsigned int local_cap;                         // 2 x largest tile + halo so far
+    std::vector< std::pair<int, double> > pairs;
+};
+
+
+voronoi_scratch *NewVoronoiScratch()
+{
+    voronoi_scratch *S = new voronoi_scratch;
+    S->local_cap = 0;
+    return S;
+}
+
+
+void FreeVoronoiScratch(voronoi_scratch *S)
+{
+    delete S;
+}
+
+
+static bool InRect(const rect &R, double x, double y)
+{
+    return (x >= R.x0 && x <= R.x1 && y >= R.y0 && y <= R.y1);
+}
+
+
+static int Clamp(int c, int n)
+{
+    return std::min(std::max(c, 0), n - 1);
+}
+
+
+static int CellCoord(double x, double x0, double cs, int n)
+{
+    double c = floor((x - x0) / cs);
+    return Clamp(static_cast<int>(fmin(fmax(c, -1), n)), n);
+}
+
+
+static void BuildBuckets(bucket_grid &G, const std::vector<double> &x,
+                         const std::vector<double> &y, std::vector<unsigned int> &cell,
+                         std::vector<unsigned int> &fill)
+{
+    unsigned int n = x.size();
+    G.box.x0 = G.box.y0 = std::numeric_limits<double>::max();
+    G.box.x1 = G.box.y1 = std::numeric_limits<double>::lowest();
+    for (unsigned int i=0; i<n; i++){
+        G.box.x0 = fmin(G.box.x0, x[i]);
+        G.box.x1 = fmax(G.box.x1, x[i]);
+        G.box.y0 = fmin(G.box.y0, y[i]);
+        G.box.y1 = fmax(G.box.y1, y[i]);
+    }
+    double w = fmax(G.box.x1 - G.box.x0, G.box.y1 - G.box.y0);
+    int m = std::max(1, static_cast<int>(sqrt(n / 4.0)));
+    G.cs = (w > 0) ? w / m : 1;
+    G.nx = std::min(m, static_cast<int>((G.box.x1 - G.box.x0) / G.cs) + 1);
+    G.ny = std::min(m, static_cast<int>((G.box.y1 - G.box.y0) / G.cs) + 1);
+    cell.resize(n);
+    G.start.reserve(m * m + 1);     // nx, ny change with the aspect ratio
+    G.start.assign(G.nx * G.ny + 1, 0);
+    for (unsigned int i=0; i<n; i++){
+        cell[i] = CellCoord(x[i], G.box.x0, G.cs, G.nx)
+                  + G.nx * CellCoord(y[i], G.box.y0, G.cs, G.ny);
+        G.start[cell[i] + 1]++;
+    }
+    for (unsigned int c=0; c<G.start.size()-1; c++)
+        G.start[c + 1] += G.start[c];
+    fill.assign(G.start.begin(), G.start.end() - 1);
+    G.idx.resize(n);
+    for (unsigned int i=0; i<n; i++)
+        G.idx[fill[cell[i]]++] = i;
+    // coincident points (e.g. agents pinned in a corner): the triangulation
+    // keeps only 1 vertex, here always the one with the lowest index
+    G.dup.assign(n, 0);
+    for (unsigned int c=0; c<G.start.size()-1; c++){
+        std::sort(G.idx.begin() + G.start[c], G.idx.begin() + G.start[c+1],
+                  [&x, &y](unsigned int a, unsigned int b){
+            return (x[a] < x[b]) || (x[a] == x[b] && (y[a] < y[b] ||
+                                                       (y[a] == y[b] && a < b)));
+        });
+        for (unsigned int k=G.start[c]+1; k<G.start[c+1]; k++){
+            unsigned int a = G.idx[k-1];
+            unsigned int b = G.idx[k];
+            G.dup[b] = (x[a] == x[b] && y[a] == y[b]);
+        }
+    }
+}
+
+
+static double Cross(const std::vector<double> &x, const std::vector<double> &y,
+                    unsigned int o, unsigned int a, unsigned int b)
+{
+    return (x[a] - x[o]) * (y[b] - y[o]) - (y[a] - y[o]) * (x[b] - x[o]);
+}
+
+
+static void HullEdges(const std::vector<double> &x, const std::vector<double> &y,
+                      const std::vector<char> &dup,
+                      std::vector< std::pair<int, int> > &edges, std::vector<unsigned int> &poly,
+                      std::vector<unsigned int> &P, std::vector<unsigned int> &H)
+{
+    // edges (i < j) of the convex hull of all points (monotone chain),
+    // collinear points on the hull are kept (e.g. agents pinned to the wall
+    // with BC=1: each piece is a Delaunay edge), points inside the polygon
+    // of the extreme points in 8 directions are skipped before (Akl-Toussaint),
+    // coincident points (dup) are not in the triangulation and skipped as well
+    unsigned int n = x.size();
+    const double dir[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1},
+                              {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+    unsigned int ext[8];
+    for (unsigned int k=0; k<8; k++){
+        ext[k] = 0;
+        for (unsigned int i=1; i<n; i++)
+            if (dir[k][0] * x[i] + dir[k][1] * y[i] >
+                dir[k][0] * x[ext[k]] + dir[k][1] * y[ext[k]])
+                ext[k] = i;
+    }
+    poly.resize(0);
+    for (unsigned int k=0; k<8; k++)
+        if (poly.size() == 0 || (ext[k] != poly.back() && ext[k] != poly[0]))
+            poly.push_back(ext[k]);
+    P.resize(0);
+    P.reserve(n);
+    H.reserve(2 * n);
+    for (unsigned int i=0; i<n; i++){
+        if (dup[i])
+            continue;
+        bool inside = (poly.size() > 2);
+        for (unsigned int k=0; k<poly.size() && inside; k++)
+            inside = (Cross(x, y, poly[k], poly[(k + 1) % poly.size()], i) > 0);
+        if (!inside)
+            P.push_back(i);
+    }
+    std::sort(P.begin(), P.end(), [&x, &y](unsigned int a, unsigned int b){
+        return (x[a] < x[b]) || (x[a] == x[b] && (y[a] < y[b] ||
+                                                   (y[a] == y[b] && a < b)));
+    });
+    edges.resize(0);
+    edges.reserve(n);
+    if (P.size() < 2)
+        return;
+    H.resize(2 * P.size());
+    int k = 0;
+    for (unsigned int i=0; i<P.size(); i++){
+        while (k >= 2 && Cross(x, y, H[k-2], H[k-1], P[i]) < 0)
+            k--;
+        H[k++] = P[i];
+    }
+    for (int i=P.size()-2, t=k+1; i>=0; i--){
+        while (k >= t && Cross(x, y, H[k-2], H[k-1], P[i]) < 0)
+            k--;
+        H[k++] = P[i];
+    }
+    for (int i=0; i<k-1; i++)
+        edges.push_back(std::make_pair(std::min(H[i], H[i+1]),
+                                       std::max(H[i], H[i+1])));
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());  // all collinear
+}
+
+
+static void Circumcircle(int i, int j, int k, const std::vector<double> &x,
+                         const std::vector<double> &y, double c[2], double &r2)
+{
+    // vertices in ascending order -> same result in every tile
+    if (i > j) std::swap(i, j);
+    if (j > k) std::swap(j, k);
+    if (i > j) std::swap(i, j);
+    double ax = x[j] - x[i];
+    double ay = y[j] - y[i];
+    double bx = x[k] - x[i];
+    double by = y[k] - y[i];
+    double a2 = ax * ax + ay * ay;
+    double b2 = bx * bx + by * by;
+    double d = 2 * (ax * by - ay * bx);
+    double ux = (by * a2 - ay * b2) / d;
+    double uy = (ax * b2 - bx * a2) / d;
+    c[0] = x[i] + ux;
+    c[1] = y[i] + uy;
+    r2 = ux * ux + uy * uy;
+}
+
+
+static bool FaceCertified(Delaunay &t, Face_handle f, const rect &R,
+                          const bucket_grid &G, const std::vector<double> &x,
+                          const std::vector<double> &y,
+                          const std::vector< std::pair<int, int> > &hull)
+{
+    // true if f is a face of the global triangulation
+    if (t.is_infinite(f)){
+        int m = f->index(t.infinite_vertex());
+        int p = f->vertex(f->ccw(m))->info();
+        int q = f->vertex(f->cw(m))->info();
+        return std::binary_search(hull.begin(), hull.end(),
+                                  std::make_pair(std::min(p, q), std::max(p, q)));
+    }
+    double c[2], r2;
+    Circumcircle(f->vertex(0)->info(), f->vertex(1)->info(),
+                 f->vertex(2)->info(), x, y, c, r2);
+    if (!(r2 < std::numeric_limits<double>::infinity()))
+        return false;
+    double r = sqrt(r2);
+    if (c[0] - r >= R.x0 && c[0] + r <= R.x1 && c[1] - r >= R.y0 && c[1] + r <= R.y1)
+        return true;
+    // circle reaches out of tile + halo: check points outside
+    r2 *= 1 + 1e-10;    // conservative for points on the circle
+    int cx0 = CellCoord(c[0] - r, G.box.x0, G.cs, G.nx);
+    int cx1 = CellCoord(c[0] + r, G.box.x0, G.cs, G.nx);
+    int cy0 = CellCoord(c[1] - r, G.box.y0, G.cs, G.ny);
+    int cy1 = CellCoord(c[1] + r, G.box.y0, G.cs, G.ny);
+    for (int cy=cy0; cy<=cy1; cy++){
+        for (int cx=cx0; cx<=cx1; cx++){
+            // cells at the border of the grid also hold the clamped points
+            double lx = (cx == 0) ? G.box.x0 : G.box.x0 + cx * G.cs;
+            double hx = (cx == G.nx - 1) ? G.box.x1 : G.box.x0 + (cx + 1) * G.cs;
+            double ly = (cy == 0) ? G.box.y0 : G.box.y0 + cy * G.cs;
+            double hy = (cy == G.ny - 1) ? G.box.y1 : G.box.y0 + (cy + 1) * G.cs;
+            if (lx >= R.x0 && hx <= R.x1 && ly >= R.y0 && hy <= R.y1)
+                continue;
+            double dx = fmax(fmax(lx - c[0], c[0] - hx), 0);
+            double dy = fmax(fmax(ly - c[1], c[1] - hy), 0);
+            if (dx * dx + dy * dy >= r2)
+                continue;
+            int cell = cx + cy * G.nx;
+            for (unsigned int k=G.start[cell]; k<G.start[cell+1]; k++){
+                unsigned int p = G.idx[k];
+                if (InRect(R, x[p], y[p]))
+                    continue;
+                dx = x[p] - c[0];
+                dy = y[p] - c[1];
+                if (dx * dx + dy * dy < r2)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+static void TileNeighbors(const rect &T, int tile, double h,
+                          const std::vector<double> &x, const std::vector<double> &y,
+                          const std::vector<int> &id, const std::vector<int> &owner_tile,
+                          const bucket_grid &G,
+                          const std::vector< std::pair<int, int> > &hull,
+                          tile_edges &out)
+{
+    // owner_tile[p]: tile of owned point p (-1: not owned or not needed)
+    unsigned int n_own = owner_tile.size();
+    std::vector< std::pair<Point, int> > &local = out.local;
+    out.owner.resize(0);
+    out.nb.resize(0);
+    out.edge.resize(0);
+    while (true){
+        rect R = {T.x0 - h, T.y0 - h, T.x1 + h, T.y1 + h};
+        bool all = (R.x0 <= G.box.x0 && R.y0 <= G.box.y0 &&
+                    R.x1 >= G.box.x1 && R.y1 >= G.box.y1);
+        local.resize(0);
+        int cx0 = CellCoord(R.x0, G.box.x0, G.cs, G.nx);
+        int cx1 = CellCoord(R.x1, G.box.x0, G.cs, G.nx);
+        int cy0 = CellCoord(R.y0, G.box.y0, G.cs, G.ny);
+        int cy1 = CellCoord(R.y1, G.box.y0, G.cs, G.ny);
+        for (int cy=cy0; cy<=cy1; cy++)
+            for (int cx=cx0; cx<=cx1; cx++){
+                int cell = cx + cy * G.nx;
+                for (unsigned int k=G.start[cell]; k<G.start[cell+1]; k++){
+                    unsigned int p = G.idx[k];
+                    if (!G.dup[p] && InRect(R, x[p], y[p]))
+                        local.push_back(std::make_pair(Point(x[p], y[p]), p));
+                }
+            }
+        foreign_alloc_scope fs;
+        Delaunay t;
+        t.insert(local.begin(), local.end());
+        fs.end();
+        // certify the faces around the owned points
+        // (tile + halo covers all points -> global triangulation)
+        bool certified = true;
+        if (!all){
+            for (Delaunay::All_faces_iterator fit=t.all_faces_begin();
+                 fit!=t.all_faces_end() && certified; fit++){
+                Face_handle f = fit;
+                bool owned = false;
+                for (int k=0; k<3; k++){
+                    if (t.is_infinite(f->vertex(k)))
+                        continue;
+                    unsigned int p = f->vertex(k)->info();
+                    owned = owned || (p < n_own && owner_tile[p] == tile);
+                }
+                if (owned)
+                    certified = FaceCertified(t, f, R, G, x, y, hull);
+            }
+        }
+        if (!certified){
+            h *= 2;
+            continue;
+        }
+        // <= 3 edges per point, each at most twice (no reallocation if
+        // the # of agents starting a burst or of the points changes)
+        out.owner.reserve(6 * local.capacity());
+        out.nb.reserve(6 * local.capacity());
+        out.edge.reserve(6 * local.capacity());
+        for (Delaunay::Finite_edges_iterator ei=t.finite_edges_begin();
+             ei!=t.finite_edges_end(); ei++){
+            Face_handle f = ei->first;
+            int i = ei->second;
+            unsigned int p = f->vertex(f->cw(i))->info();
+            unsigned int q = f->vertex(f->ccw(i))->info();
+            bool own_p = (p < n_own && owner_tile[p] == tile);
+            bool own_q = (q < n_own && owner_tile[q] == tile);
+            if (!own_p && !own_q)
+                continue;
+            // voronoi edge: between circumcenters of the 2 adjacent faces
+            Face_handle g = f->neighbor(i);
+            double edge = std::numeric_limits<double>::infinity();
+            if (!t.is_infinite(f) && !t.is_infinite(g)){
+                double c1[2], c2[2], r2;
+                Circumcircle(f->vertex(0)->info(), f->vertex(1)->info(),
+                             f->vertex(2)->info(), x, y, c1, r2);
+                Circumcircle(g->vertex(0)->info(), g->vertex(1)->info(),
+                             g->vertex(2)->info(), x, y, c2, r2);
+                edge = sqrt((c1[0] - c2[0]) * (c1[0] - c2[0]) +
+                            (c1[1] - c2[1]) * (c1[1] - c2[1]));
+            }
+            if (own_p){
+                out.owner.push_back(p);
+                out.nb.push_back(id[q]);
+                out.edge.push_back(edge);
+            }
+            if (own_q){
+                out.owner.push_back(q);
+                out.nb.push_back(id[p]);
+                out.edge.push_back(edge);
+            }
+        }
+        return;
+    }
+}
+
+
+static void MergeEdges(const std::vector<tile_edges> &found, const std::vector<int> &tiles,
+                       const std::vector<int> &id, unsigned int n_own,
+                       std::vector< std::pair<int, double> > &pairs,
+                       std::vector<unsigned int> &fill, neighbor_list &NL)
+{
+    // sort neighbors of each owner, remove duplicates (periodic copies
+    // of the same agent) and the owner itself
+    for (unsigned int t=0; t<tiles.size(); t++){
+        const tile_edges &F = found[tiles[t]];
+        for (unsigned int e=0; e<F.owner.size(); e++)
+            NL.start[F.owner[e] + 1]++;
+    }
+    for (unsigned int i=0; i<n_own; i++)
+        NL.start[i + 1] += NL.start[i];
+    pairs.reserve(6 * id.size());
+    pairs.resize(NL.start[n_own]);
+    fill.assign(NL.start.begin(), NL.start.end() - 1);
+    for (unsigned int t=0; t<tiles.size(); t++){
+        const tile_edges &F = found[tiles[t]];
+        for (unsigned int e=0; e<F.owner.size(); e++)
+            pairs[fill[F.owner[e]]++] = std::make_pair(F.nb[e], F.edge[e]);
+    }
+    NL.nb.reserve(pairs.capacity());
+    NL.edge.reserve(pairs.capacity());
+    unsigned int begin = 0;
+    for (unsigned int i=0; i<n_own; i++){
+        unsigned int end = NL.start[i + 1];
+        std::sort(pairs.begin() + begin, pairs.begin() + end);
+        NL.start[i] = NL.nb.size();
+        for (unsigned int e=begin; e<end; e++){
+            if (pairs[e].first == id[i])
+                continue;
+            if (NL.nb.size() > NL.start[i] && NL.nb.back() == pairs[e].first)
+                continue;
+            NL.nb.push_back(pairs[e].first);
+            NL.edge.push_back(pairs[e].second);
+        }
+        begin = end;
+    }
+    NL.start[n_own] = NL.nb.size();
+}
+
+
+void VoronoiNeighborsTiled(const std::vector<double> &x, const std::vector<double> &y,
+                           const std::vector<int> &id, unsigned int n_own,
+                           const std::vector<char> &need, unsigned int threads,
+                           neighbor_list &NL, phase_timers *timers,
+                           voronoi_scratch *S)
+{
+    NL.start.assign(n_own + 1, 0);
+    NL.nb.resize(0);
+    NL.edge.resize(0);
+    if (n_own == 0)
+        return;
+    voronoi_scratch tmp;
+    tmp.local_cap = 0;
+    voronoi_scratch &W = (S != NULL) ? *S : tmp;
+    bucket_grid &G = W.G;
+    BuildBuckets(G, x, y, W.cell, W.fill);
+    HullEdges(x, y, G.dup, W.hull, W.poly, W.P, W.H);
+    // tiles: ~2 per thread, at least ~2000 owned points per tile
+    rect B;
+    B.x0 = B.y0 = std::numeric_limits<double>::max();
+    B.x1 = B.y1 = std::numeric_limits<double>::lowest();
+    for (unsigned int i=0; i<n_own; i++){
+        B.x0 = fmin(B.x0, x[i]);
+        B.x1 = fmax(B.x1, x[i]);
+        B.y0 = fmin(B.y0, y[i]);
+        B.y1 = fmax(B.y1, y[i]);
+    }
+    int nt = std::max(static_cast<int>(ceil(sqrt(2.0 * threads))),
+                      static_cast<int>(sqrt(n_own / 2000.0)));
+    nt = std::max(1, std::min(nt, static_cast<int>(sqrt(n_own))));
+    double tw = fmax((B.x1 - B.x0) / nt, 1e-12);
+    double th = fmax((B.y1 - B.y0) / nt, 1e-12);
+    // initial halo: 3 x mean distance of owned points
+    double h = 3 * sqrt(fmax(B.x1 - B.x0, tw) * fmax(B.y1 - B.y0, th) / n_own);
+    std::vector<int> &owner_tile = W.owner_tile;
+    std::vector<char> &active = W.active;
+    owner_tile.assign(n_own, -1);
+    active.assign(nt * nt, 0);
+    for (unsigned int i=0; i<n_own; i++){
+        if (!need[i])
+            continue;
+        int tx = Clamp(static_cast<int>(floor((x[i] - B.x0) / tw)), nt);
+        int ty = Clamp(static_cast<int>(floor((y[i] - B.y0) / th)), nt);
+        owner_tile[i] = tx + nt * ty;
+        active[owner_tile[i]] = 1;
+    }
+    std::vector<int> &tiles = W.tiles;
+    tiles.resize(0);
+    for (int k=0; k<nt*nt; k++)
+        if (active[k])
+            tiles.push_back(k);
+    // buffers per tile (not per active tile): sizes independent of the
+    // agents starting a burst
+    if (W.found.size() < static_cast<unsigned int>(nt * nt))
+        W.found.resize(nt * nt);
+    // the tiles move with the swarm: all (also inactive) get the capacity
+    // of the largest
+    for (unsigned int k=0; k<W.found.size(); k++){
+        W.found[k].local.reserve(W.local_cap);
+        W.found[k].owner.reserve(6 * W.local_cap);
+        W.found[k].nb.reserve(6 * W.local_cap);
+        W.found[k].edge.reserve(6 * W.local_cap);
+    }
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (int k=0; k<static_cast<int>(tiles.size()); k++){
+        int tx = tiles[k] % nt;
+        int ty = tiles[k] / nt;
+        rect T = {B.x0 + tx * tw, B.y0 + ty * th,
+                  B.x0 + (tx + 1) * tw, B.y0 + (ty + 1) * th};
+        std::chrono::steady_clock::time_point t0;
+        if (timers != NULL && timers->trace)
+            t0 = std::chrono::steady_clock::now();
+        TileNeighbors(T, tiles[k], h, x, y, id, owner_tile, G, W.hull, W.found[tiles[k]]);
+        if (timers != NULL && timers->trace)
+            AddTraceEvent(*timers, "tile", t0, std::chrono::steady_clock::now(),
+                          omp_get_thread_num());
+    }
+    for (unsigned int k=0; k<tiles.size(); k++)
+        W.local_cap = std::max(W.local_cap, std::min(static_cast<unsigned int>(x.size()),
+                               2 * static_cast<unsigned int>(W.found[tiles[k]].local.size())));
+    MergeEdges(W.found, tiles, id, n_own, W.pairs, W.fill, NL);
+}
+
+
+void VoronoiNeighbors(const std::vector<double> &x, const std::vector<double> &y,
+                      const std::vector<int> &id, unsigned int n_own,
+                      const std::vector<char> &need, neighbor_list &NL,
+                      voronoi_scratch *S)
+{
+    // 1 tile covering all points -> no halo, nothing to certify
+    NL.start.assign(n_own + 1, 0);
+    NL.nb.resize(0);
+    NL.edge.resize(0);
+    if (n_own == 0)
+        return;
+    voronoi_scratch tmp;
+    tmp.local_cap = 0;
+    voronoi_scratch &W = (S != NULL) ? *S : tmp;
+    bucket_grid &G = W.G;
+    BuildBuckets(G, x, y, W.cell, W.fill);
+    W.owner_tile.assign(n_own, -1);
+    for (unsigned int i=0; i<n_own; i++)
+        if (need[i])
+            W.owner_tile[i] = 0;
+    W.hull.resize(0);
+    W.tiles.assign(1, 0);
+    if (W.found.size() < 1)
+        W.found.resize(1);
+    W.found[0].local.reserve(x.size());
+    TileNeighbors(G.box, 0, 0, x, y, id, W.owner_tile, G, W.hull, W.found[0]);
+    MergeEdges(W.found, W.tiles, id, n_own, W.pairs, W.fill, NL);
+}
@@ -0,0 +1,69 @@
+/*  VoronoiTiles
+    domain-decomposed (tiled) voronoi neighbors for large N
+    for SwarmDynamics(swarmdyn.h, swarmdyn.cpp)
+    v0.1, 13.5.2020
+
+    (C) 2020 Pascal Klamser
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef voronoi_tiles_H
+#define voronoi_tiles_H
+
+#include <vector>
+#include <utility>
+#include "phase_timers.h"
+
+// The bounding box of the owned points is split into tiles which are
+// triangulated independently (in parallel) together with a halo of width h.
+// A face of a tile triangulation is a face of the global delaunay
+// triangulation if no point outside of tile + halo lies in its circumcircle
+// (infinite face: if its edge is an edge of the global convex hull).
+// If all faces around the owned points of a tile are certified, their
+// neighbors and voronoi edges are exact, else the tile is repeated with 2h.
+// The neighbor lists are sorted -> independent of the tiling and of the
+// # of threads. If timers are traced, each tile is a trace event of its thread.
+
+// neighbors in compressed sparse row format, neighbors of owned point i:
+// nb[start[i]] ... nb[start[i+1]-1] in ascending order
+struct neighbor_list{
+    std::vector<unsigned int> start;
+    std::vector<int> nb;        // id of the neighbor (< 0: predator)
+    std::vector<double> edge;   // length of shared voronoi edge (inf: unbounded)
+};
+typedef struct neighbor_list neighbor_list;
+
+// buffers reused from call to call (grid, hull, tiles, tile triangulation
+// input and found edges): no allocations once they reached their size.
+// Defined in voronoi_tiles.cpp (CGAL types), NULL: temporary buffers.
+struct voronoi_scratch;
+voronoi_scratch *NewVoronoiScratch();
+void FreeVoronoiScratch(voronoi_scratch *S);
+
+// x, y, id of all points of the triangulation: the first n_own points are
+// owned (id = index), the others only shape the triangulation (predators,
+// copies for periodic BC). Only owned points with need[i] get neighbors
+// (of coincident points only the one with the lowest index).
+void VoronoiNeighborsTiled(const std::vector<double> &x, const std::vector<double> &y,
+                           const std::vector<int> &id, unsigned int n_own,
+                           const std::vector<char> &need, unsigned int threads,
+                           neighbor_list &NL, phase_timers *timers=NULL,
+                           voronoi_scratch *S=NULL);
+// the same from a single triangulation of all points (serial)
+void VoronoiNeighbors(const std::vector<double> &x, const std::vector<double> &y,
+                      const std::vector<int> &id, unsigned int n_own,
+                      const std::vector<char> &need, neighbor_list &NL,
+                      voronoi_scratch *S=NULL);
+#endif